@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Generate bench/src/golden.h, the expected outputs of the DSP kernel
+benchmarks.
+
+The inputs are synthesised the same way as in bench/src/main.c: a
+110.5 Hz string (an A2 about 8 cents sharp) with two harmonics, 16 kHz,
+16-bit. Everything here is computed in double precision from first
+principles, not by running the firmware's code, so the golden values
+catch a kernel that drifts as well as one that got slower.
+
+Re-run after changing the synthetic input:
+
+    bench/scripts/golden.py > bench/src/golden.h
+"""
+
+import math
+
+FS = 16000
+FFT_LEN = 1024
+SIG_F0_HZ = 110.5
+SIG_AMPL = 6000.0
+SIG_HARMONICS = (1.0, 0.5, 0.25)
+SIG_LEN = 6400                      # 400 ms: four 100 ms blocks
+FRAME_START = 2 * FFT_LEN           # newest of three back-to-back frames
+
+KALMAN_STEPS = 64
+KALMAN_Q = 1e-3
+KALMAN_R = 1e-2
+
+
+def signal(n):
+    v = sum(a * math.sin(2.0 * math.pi * (k + 1) * SIG_F0_HZ * n / FS)
+            for k, a in enumerate(SIG_HARMONICS))
+    return round(SIG_AMPL * v)
+
+
+def hann(n):
+    return 0.5 * (1.0 - math.cos(2.0 * math.pi * n / FFT_LEN))
+
+
+def dft_mag(x, k):
+    re = sum(v * math.cos(2.0 * math.pi * k * n / FFT_LEN)
+             for n, v in enumerate(x))
+    im = sum(v * math.sin(2.0 * math.pi * k * n / FFT_LEN)
+             for n, v in enumerate(x))
+    return math.hypot(re, im)
+
+
+def kalman():
+    z = [SIG_F0_HZ + 0.3 * math.sin(0.7 * i) for i in range(KALMAN_STEPS)]
+    x, p = z[0], KALMAN_R
+    for v in z[1:]:
+        p += KALMAN_Q
+        k = p / (p + KALMAN_R)
+        x += k * (v - x)
+        p *= 1.0 - k
+    return x, p
+
+
+def main():
+    frame = [signal(FRAME_START + n) * hann(n) for n in range(FFT_LEN)]
+    bin_hz = FS / FFT_LEN
+    peak = round(SIG_F0_HZ / bin_hz)
+    a, b, c = (dft_mag(frame, k) for k in (peak - 1, peak, peak + 1))
+    delta = 0.5 * (a - c) / (a - 2.0 * b + c)
+    x, p = kalman()
+
+    print("/* Generated by bench/scripts/golden.py, do not edit */")
+    print()
+    print("#ifndef GOLDEN_H")
+    print("#define GOLDEN_H")
+    print()
+    print("/* Window: energy of the windowed newest frame */")
+    print(f"#define GOLDEN_WIN_ENERGY  {sum(v * v for v in frame):.9e}")
+    print()
+    print("/* CFFT + magnitude around the fundamental */")
+    print(f"#define GOLDEN_PEAK_BIN    {peak}")
+    print(f"#define GOLDEN_MAG_LO      {a:.9e}")
+    print(f"#define GOLDEN_MAG_PEAK    {b:.9e}")
+    print(f"#define GOLDEN_MAG_HI      {c:.9e}")
+    print()
+    print("/* Parabolic interpolation over those three bins */")
+    print(f"#define GOLDEN_PARABOLIC_HZ {(peak + delta) * bin_hz:.6f}")
+    print()
+    print("/* Kalman filter after the fixed measurement sequence */")
+    print(f"#define GOLDEN_KALMAN_X    {x:.6f}")
+    print(f"#define GOLDEN_KALMAN_P    {p:.9e}")
+    print()
+    print("#endif /* GOLDEN_H */")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,22 @@
+/* Generated by bench/scripts/golden.py, do not edit */
+
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+/* Window: energy of the windowed newest frame */
+#define GOLDEN_WIN_ENERGY  9.072004218e+09
+
+/* CFFT + magnitude around the fundamental */
+#define GOLDEN_PEAK_BIN    7
+#define GOLDEN_MAG_LO      6.857542534e+05
+#define GOLDEN_MAG_PEAK    1.530720154e+06
+#define GOLDEN_MAG_HI      8.513937009e+05
+
+/* Parabolic interpolation over those three bins */
+#define GOLDEN_PARABOLIC_HZ 110.223957
+
+/* Kalman filter after the fixed measurement sequence */
+#define GOLDEN_KALMAN_X    110.419186
+#define GOLDEN_KALMAN_P    2.701562119e-03
+
+#endif /* GOLDEN_H */
@@ -0,0 +1,381 @@
+/* bench/src/main.c
+ *
+ * Cost and golden-output checks for the pitch kernels, as a ztest suite.
+ *
+ * Every kernel runs over a fixed synthetic input: a 110.5 Hz string (an
+ * A2 about 8 cents sharp) with two harmonics at 16 kHz. It is built
+ * from the apps' own sources (dsp/lib, dsp/src/hann.h and
+ * ble_central/src/kalman.h), so the suite times and checks exactly what
+ * ships. Each kernel prints one line:
+ *
+ *   BENCH <kernel> cycles <n> ns <n> [instr <n>]
+ *
+ * per call, averaged over the runs. Under QEMU with icount every
+ * instruction advances virtual time by 2^shift ns, which makes the
+ * elapsed time an instruction count; on hardware the cycles are real.
+ * The assertions compare each output with bench/src/golden.h, computed
+ * in double precision on the host by bench/scripts/golden.py.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/timing/timing.h>
+#include <zephyr/ztest.h>
+#include "arm_math.h"
+#include "arm_const_structs.h"
+#include "hann.h"
+#include "kalman.h"
+#include "multires.h"
+#include "peak_picker.h"
+#include "phase_vocoder.h"
+#include "tuning.h"
+#include "golden.h"
+
+#define FS            16000
+#define FFT_LEN       HANN_LEN
+
+/* Synthetic input, as in bench/scripts/golden.py */
+#define SIG_F0_HZ     110.5
+#define SIG_AMPL      6000.0
+#define SIG_LEN       6400              /* 400 ms */
+#define BLOCK_LEN     1600              /* one 100 ms microphone block */
+#define BLOCK_US      100000
+#define FRAMES        PV_DEPTH          /* back-to-back FFT frames */
+#define NEWEST        (FRAMES - 1)      /* the frame everything checks */
+
+#define KALMAN_STEPS  64
+#define KALMAN_Q      1e-3f
+#define KALMAN_R      1e-2f
+
+/* Calls per measurement: QEMU is deterministic under icount, this only
+ * evens out the timer's granularity */
+#define RUNS          8
+
+/* Phase-vocoder band, as in dsp/src/main.c */
+#define PV_FIRST_BIN  2
+
+static const float32_t sig_harmonics[] = { 1.0f, 0.5f, 0.25f };
+
+static int16_t   sig[SIG_LEN];
+static float32_t windowed[FFT_LEN];
+static float32_t cbuf[2 * FFT_LEN];
+static float32_t mag[FFT_LEN];
+static const struct tuning_table *tuning;
+
+/* --- Measurement -------------------------------------------------- */
+
+struct bench {
+    timing_t t0;
+    uint64_t cycles;
+    uint32_t calls;
+};
+
+static void bench_start(struct bench *b)
+{
+    b->t0 = timing_counter_get();
+}
+
+static void bench_stop(struct bench *b, uint32_t calls)
+{
+    timing_t t1 = timing_counter_get();
+    b->cycles += timing_cycles_get(&b->t0, &t1);
+    b->calls  += calls;
+}
+
+static void bench_report(const struct bench *b, const char *kernel)
+{
+    uint32_t cycles = (uint32_t)(b->cycles / b->calls);
+    uint32_t ns     = (uint32_t)(timing_cycles_to_ns(b->cycles) / b->calls);
+
+#if defined(CONFIG_QEMU_ICOUNT)
+    printk("BENCH %s cycles %u ns %u instr %u\n", kernel, cycles, ns,
+           ns >> CONFIG_QEMU_ICOUNT_SHIFT);
+#else
+    printk("BENCH %s cycles %u ns %u\n", kernel, cycles, ns);
+#endif
+}
+
+/* --- Pipeline steps, as in dsp/src/main.c analyse_window() --------- */
+
+static const int16_t *frame_pcm(uint8_t frame)
+{
+    return &sig[frame * FFT_LEN];
+}
+
+static void window(const int16_t *pcm)
+{
+    for (uint16_t n = 0; n < FFT_LEN; n++) {
+        windowed[n] = (float32_t)pcm[n] * hann[n];
+    }
+}
+
+static void load_cbuf(void)
+{
+    for (uint16_t n = 0; n < FFT_LEN; n++) {
+        cbuf[2*n]     = windowed[n];
+        cbuf[2*n + 1] = 0.0f;
+    }
+}
+
+static void magnitudes(void)
+{
+    arm_cmplx_mag_f32(&cbuf[2 * tuning->span_lo], &mag[tuning->span_lo],
+                      tuning->span_hi - tuning->span_lo + 1);
+}
+
+static void spectrum_of(uint8_t frame)
+{
+    window(frame_pcm(frame));
+    load_cbuf();
+    arm_cfft_f32(&arm_cfft_sR_f32_len1024, cbuf, 0, 1);
+}
+
+static float32_t cents(float32_t f, float32_t ref)
+{
+    return 1200.0f * log2f(f / ref);
+}
+
+/* --- Tests -------------------------------------------------------- */
+
+ZTEST(dsp_bench, test_window)
+{
+    struct bench b = { 0 };
+
+    /* The table itself: a regenerated one must still be a periodic Hann */
+    float32_t worst = 0.0f;
+    for (uint16_t n = 0; n < HANN_LEN; n++) {
+        float32_t w = 0.5f - 0.5f * cosf(2.0f * PI * n / HANN_LEN);
+        worst = MAX(worst, fabsf(hann[n] - w));
+    }
+    zassert_true(worst < 1e-6f, "hann[] off by %e", (double)worst);
+
+    for (uint8_t r = 0; r < RUNS; r++) {
+        bench_start(&b);
+        window(frame_pcm(NEWEST));
+        bench_stop(&b, 1);
+    }
+    bench_report(&b, "window");
+
+    double energy = 0.0;
+    for (uint16_t n = 0; n < FFT_LEN; n++) {
+        energy += (double)windowed[n] * windowed[n];
+    }
+    zassert_within(energy, GOLDEN_WIN_ENERGY, GOLDEN_WIN_ENERGY * 1e-5,
+                   "window energy %e", energy);
+}
+
+ZTEST(dsp_bench, test_cfft_mag)
+{
+    struct bench fft = { 0 };
+    struct bench cmag = { 0 };
+
+    window(frame_pcm(NEWEST));
+    for (uint8_t r = 0; r < RUNS; r++) {
+        load_cbuf();
+        bench_start(&fft);
+        arm_cfft_f32(&arm_cfft_sR_f32_len1024, cbuf, 0, 1);
+        bench_stop(&fft, 1);
+    }
+    bench_report(&fft, "cfft_1024");
+
+    for (uint8_t r = 0; r < RUNS; r++) {
+        bench_start(&cmag);
+        magnitudes();
+        bench_stop(&cmag, 1);
+    }
+    bench_report(&cmag, "cmplx_mag");
+
+    const uint16_t k = GOLDEN_PEAK_BIN;
+    zassert_within(mag[k - 1], GOLDEN_MAG_LO, GOLDEN_MAG_LO * 1e-4,
+                   "bin %u: %e", k - 1, (double)mag[k - 1]);
+    zassert_within(mag[k], GOLDEN_MAG_PEAK, GOLDEN_MAG_PEAK * 1e-4,
+                   "bin %u: %e", k, (double)mag[k]);
+    zassert_within(mag[k + 1], GOLDEN_MAG_HI, GOLDEN_MAG_HI * 1e-4,
+                   "bin %u: %e", k + 1, (double)mag[k + 1]);
+}
+
+ZTEST(dsp_bench, test_peak_pick)
+{
+    struct bench b = { 0 };
+    struct peak_result peak;
+
+    spectrum_of(NEWEST);
+    magnitudes();
+
+    /* Band search plus parabolic interpolation. The noise floor starts
+     * empty, so the confidence gate may well reject the frame; bin and
+     * frequency are filled in either way. */
+    for (uint8_t r = 0; r < RUNS; r++) {
+        peak_picker_init(FFT_LEN, FS);
+        bench_start(&b);
+        (void)peak_picker_run(mag, tuning, &peak);
+        bench_stop(&b, 1);
+    }
+    bench_report(&b, "peak_pick");
+
+    zassert_equal(peak.bin, GOLDEN_PEAK_BIN, "peak in bin %u", peak.bin);
+    zassert_within(peak.freq_hz, GOLDEN_PARABOLIC_HZ, 1e-3,
+                   "parabolic %f Hz", (double)peak.freq_hz);
+}
+
+ZTEST(dsp_bench, test_phase_vocoder)
+{
+    struct bench b = { 0 };
+
+    zassert_equal(pv_init(FFT_LEN, FS, PV_FIRST_BIN, PV_MAX_BINS), 0);
+    for (uint8_t m = 0; m < FRAMES; m++) {
+        spectrum_of(m);
+        pv_push(cbuf, m ? FFT_LEN : 0);
+    }
+
+    float32_t f = 0.0f;
+    for (uint8_t r = 0; r < RUNS; r++) {
+        bench_start(&b);
+        f = pv_refine(GOLDEN_PEAK_BIN, GOLDEN_PARABOLIC_HZ);
+        bench_stop(&b, 1);
+    }
+    bench_report(&b, "pv_refine");
+
+    zassert_within(f, SIG_F0_HZ, 0.02, "refined %f Hz", (double)f);
+}
+
+ZTEST(dsp_bench, test_string_for)
+{
+    /* Standard tuning, as tuning.c loads it with nothing stored */
+    static const char *const notes[] = { "E2", "A2", "D3", "G3", "B3", "E4" };
+    static const uint8_t midi[] = { 40, 45, 50, 55, 59, 64 };
+    struct bench b = { 0 };
+
+    zassert_equal(tuning->count, ARRAY_SIZE(notes));
+    for (uint8_t i = 0; i < ARRAY_SIZE(notes); i++) {
+        float32_t f = 440.0f * exp2f((midi[i] - 69) / 12.0f);
+        zassert_true(strcmp(tuning->s[i].note, notes[i]) == 0,
+                     "string %u is %s", i, tuning->s[i].note);
+        zassert_within(tuning->s[i].freq_hz, f, 1e-3, "%s at %f Hz",
+                       notes[i], (double)tuning->s[i].freq_hz);
+    }
+
+    /* Each string in tune and 30 cents either side, then two pitches
+     * no string owns */
+    float32_t probe[3 * ARRAY_SIZE(notes) + 2];
+    int       expect[ARRAY_SIZE(probe)];
+    uint8_t   n = 0;
+    for (uint8_t i = 0; i < ARRAY_SIZE(notes); i++) {
+        for (int c = -30; c <= 30; c += 30) {
+            probe[n]  = tuning->s[i].freq_hz * exp2f(c / 1200.0f);
+            expect[n] = i;
+            n++;
+        }
+    }
+    probe[n] = 60.0f;
+    expect[n++] = -1;
+    probe[n] = 2000.0f;
+    expect[n++] = -1;
+
+    int got[ARRAY_SIZE(probe)];
+    for (uint8_t r = 0; r < RUNS; r++) {
+        bench_start(&b);
+        for (uint8_t i = 0; i < n; i++) {
+            got[i] = tuning_string_for(tuning, probe[i]);
+        }
+        bench_stop(&b, n);
+    }
+    bench_report(&b, "string_for");
+
+    for (uint8_t i = 0; i < n; i++) {
+        zassert_equal(got[i], expect[i], "%f Hz -> string %d",
+                      (double)probe[i], got[i]);
+    }
+}
+
+ZTEST(dsp_bench, test_kalman)
+{
+    struct bench b = { 0 };
+    float32_t z[KALMAN_STEPS];
+    struct kalman k;
+
+    for (uint8_t i = 0; i < KALMAN_STEPS; i++) {
+        z[i] = (float32_t)SIG_F0_HZ + 0.3f * sinf(0.7f * i);
+    }
+
+    for (uint8_t r = 0; r < RUNS; r++) {
+        bench_start(&b);
+        kalman_reset(&k, z[0], KALMAN_R);
+        for (uint8_t i = 1; i < KALMAN_STEPS; i++) {
+            kalman_predict(&k, KALMAN_Q);
+            kalman_update(&k, z[i], KALMAN_R);
+        }
+        bench_stop(&b, KALMAN_STEPS - 1);
+    }
+    bench_report(&b, "kalman_step");
+
+    zassert_within(k.x, GOLDEN_KALMAN_X, 1e-3, "x %f", (double)k.x);
+    zassert_within(k.p, GOLDEN_KALMAN_P, GOLDEN_KALMAN_P * 1e-3,
+                   "p %e", (double)k.p);
+}
+
+ZTEST(dsp_bench, test_multires)
+{
+    struct bench push = { 0 };
+    struct bench zoom = { 0 };
+    uint32_t t_us = 0;
+
+    /* A fresh decimator, fed the whole signal as microphone blocks */
+    const struct nus_resolution_cmd multi = {
+        .cmd     = NUS_CMD_RESOLUTION,
+        .mode    = MULTIRES_MULTI,
+        .periods = MULTIRES_PERIODS_DEF,
+    };
+    zassert_equal(multires_init(FS), 0);
+    zassert_equal(multires_set(&multi), 0);
+    for (uint32_t off = 0; off + BLOCK_LEN <= SIG_LEN; off += BLOCK_LEN) {
+        bench_start(&push);
+        multires_push(&sig[off], BLOCK_LEN, t_us);
+        bench_stop(&push, 1);
+        t_us += BLOCK_US;
+    }
+    bench_report(&push, "multires_push");
+
+    const struct tuning_string *a2 = &tuning->s[1];
+    float32_t f = 0.0f;
+    bool ok = false;
+    for (uint8_t r = 0; r < RUNS; r++) {
+        bench_start(&zoom);
+        ok = multires_measure(a2->freq_hz, GOLDEN_PARABOLIC_HZ, 0, &f);
+        bench_stop(&zoom, 1);
+    }
+    bench_report(&zoom, "multires_zoom");
+
+    zassert_true(ok, "no measurement");
+    zassert_within(cents(f, SIG_F0_HZ), 0.0f, 1.0f, "measured %f Hz",
+                   (double)f);
+}
+
+/* --- Suite -------------------------------------------------------- */
+
+static void *bench_setup(void)
+{
+    for (uint32_t n = 0; n < SIG_LEN; n++) {
+        double v = 0.0;
+        for (uint8_t k = 0; k < ARRAY_SIZE(sig_harmonics); k++) {
+            v += sig_harmonics[k] *
+                 sin(2.0 * M_PI * (k + 1) * SIG_F0_HZ * n / FS);
+        }
+        sig[n] = (int16_t)lrint(SIG_AMPL * v);
+    }
+
+    tuning_init(FFT_LEN, FS);
+    tuning = tuning_active();
+
+    timing_init();
+    timing_start();
+
+    printk("DSP kernel benchmarks on %s, FPU %s\n", CONFIG_BOARD,
+           IS_ENABLED(CONFIG_FPU) ? "on" : "off");
+    return NULL;
+}
+
+ZTEST_SUITE(dsp_bench, NULL, bench_setup, NULL, NULL, NULL);
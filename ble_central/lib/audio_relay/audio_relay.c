@@ -0,0 +1,71 @@
+/* lib/audio_relay/audio_relay.c
+ *
+ * Raw audio packet forwarding to the console.
+ */
+
+#include "audio_relay.h"
+#include "loss_stats.h"
+
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/base64.h>
+#include <zephyr/sys/printk.h>
+
+#define RELAY_STACK_SIZE 1024
+#define RELAY_PRIORITY   10         /* below main() and data fusion */
+
+/* "AU " + 28 base64 characters + newline, 10 bits each on an 8N1 UART */
+#define LINE_BITS        (32 * 10)
+
+#if defined(CONFIG_UART_CONSOLE) && DT_HAS_CHOSEN(zephyr_console) && \
+    DT_NODE_HAS_PROP(DT_CHOSEN(zephyr_console), current_speed)
+#define CONSOLE_BAUD     DT_PROP(DT_CHOSEN(zephyr_console), current_speed)
+#else
+#define CONSOLE_BAUD     0          /* not a UART, no limit */
+#endif
+
+K_MSGQ_DEFINE(audio_q, sizeof(struct nus_audio_frame), AUDIO_RELAY_DEPTH, 1);
+
+uint32_t audio_relay_max_rate(void)
+{
+    if (CONSOLE_BAUD == 0) {
+        return UINT32_MAX;
+    }
+    /* Leave a tenth of the console for pitch lines and the shell */
+    return (uint32_t)CONSOLE_BAUD * 9U / 10U / LINE_BITS * NUS_AUDIO_SAMPLES;
+}
+
+void audio_relay_start(uint32_t rate_hz)
+{
+    k_msgq_purge(&audio_q);
+    printk("AUDIO %u\n", rate_hz);
+}
+
+void audio_relay_packet(const uint8_t *data, uint16_t len)
+{
+    if (len < sizeof(struct nus_audio_frame)) {
+        return;
+    }
+    if (k_msgq_put(&audio_q, data, K_NO_WAIT) != 0) {
+        loss_stats_inc(CTR_AUDIO_QUEUE_FULL);
+    }
+}
+
+static void relay_entry(void *p1, void *p2, void *p3)
+{
+    struct nus_audio_frame pkt;
+    /* base64 of a 20-byte packet is 28 characters plus NUL */
+    uint8_t line[32];
+    size_t  olen;
+
+    while (1) {
+        k_msgq_get(&audio_q, &pkt, K_FOREVER);
+        if (base64_encode(line, sizeof(line), &olen, (const uint8_t *)&pkt,
+                          sizeof(pkt)) == 0) {
+            printk("AU %s\n", (char *)line);
+        }
+    }
+}
+
+K_THREAD_DEFINE(audio_relay, RELAY_STACK_SIZE, relay_entry,
+                NULL, NULL, NULL, RELAY_PRIORITY, 0, 0);
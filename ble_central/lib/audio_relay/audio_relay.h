@@ -0,0 +1,32 @@
+#ifndef AUDIO_RELAY_H
+#define AUDIO_RELAY_H
+
+#include <stdint.h>
+#include "nus_proto.h"
+
+/* Forwards NUS_FRAME_AUDIO packets on the console for
+ * scripts/audio_capture.py, one line each:
+ *
+ *   AUDIO <rate Hz>          when a capture is started
+ *   AU <base64 packet>       per 28-sample packet
+ *
+ * Packets stay IMA-ADPCM coded and are base64 rather than hex so 8 kHz
+ * fits a 115200 baud console; 16 kHz needs a faster one. Sequence gaps
+ * are left for the host to fill.
+ *
+ * Packets are queued straight from notify_func(), not through bt_msgq,
+ * so an audio stream neither crowds out pitch frames nor trips the
+ * subscription backoff. A low-priority thread prints them; when the
+ * console falls behind, audio is what gets dropped.
+ */
+#define AUDIO_RELAY_DEPTH 32
+
+/* Highest sample rate the console keeps up with */
+uint32_t audio_relay_max_rate(void);
+
+void audio_relay_start(uint32_t rate_hz);
+
+/* notify_func(): one NUS_FRAME_AUDIO notification */
+void audio_relay_packet(const uint8_t *data, uint16_t len);
+
+#endif /* AUDIO_RELAY_H */
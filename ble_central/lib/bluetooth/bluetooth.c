@@ -10,6 +10,13 @@
 
 #include "bluetooth.h"
 #include "msgq.h"
+#include "latency.h"
+#include "loss_stats.h"
+#include "subscription.h"
+#include "command.h"
+#include "log_relay.h"
+#include "audio_relay.h"
+#include "nus_proto.h"
 
 #include <zephyr/sys/printk.h>
 #include <zephyr/sys/util.h>
@@ -22,8 +29,6 @@
 #include <zephyr/bluetooth/uuid.h>
 
 #include <string.h>
-#include <stdarg.h>
-#include <stdio.h>
 
 /* ────────────────────────────────────────────────────────────────
  *  Application-level message queue (defined in main.c)
@@ -31,18 +36,27 @@
 extern struct k_msgq bt_msgq;
 
 /* ────────────────────────────────────────────────────────────────
- *  Single connection & discovery bookkeeping
+ *  Per-connection discovery bookkeeping, by bt_conn_index()
  * ────────────────────────────────────────────────────────────── */
-static struct bt_conn *default_conn;
+struct link {
+    struct bt_conn                  *conn;
+    struct bt_gatt_discover_params   disc;
+    struct bt_gatt_subscribe_params  subscribe_params;
+    struct bt_gatt_exchange_params   mtu_params;
+
+    uint16_t svc_start_handle;
+    uint16_t svc_end_handle;
+    uint16_t nus_rx_handle;
+    uint16_t tx_handle;
+    uint16_t stats_handle;
+    bool     discovery_complete;
+};
 
-static struct bt_gatt_discover_params  disc;
-static struct bt_gatt_subscribe_params subscribe_params;
+static struct link links[CONFIG_BT_MAX_CONN];
 
-static uint16_t svc_start_handle;
-static uint16_t svc_end_handle;
-static uint16_t nus_rx_handle;
-static uint16_t tx_handle;
-static bool     discovery_complete;
+/* Commands, acks, log uploads and stats reads use one link: the first
+ * to finish discovery, until it drops. -1 while there is none. */
+static atomic_t primary = ATOMIC_INIT(-1);
 
 /* forward decl so device_found() can restart scans on failure */
 static void start_scan(void);
@@ -60,12 +74,17 @@ static void start_scan(void);
 static const struct bt_uuid_128 svc_uuid = BT_UUID_INIT_128(BT_UUID_NUS_SERVICE_VAL);
 static const struct bt_uuid_128 rx_uuid  = BT_UUID_INIT_128(BT_UUID_NUS_RX_VAL);
 static const struct bt_uuid_128 tx_uuid  = BT_UUID_INIT_128(BT_UUID_NUS_TX_VAL);
+static const struct bt_uuid_128 stats_uuid = BT_UUID_INIT_128(NUS_STATS_CHAR_UUID_VAL);
+
+/* MAC addresses of the Thingy:52s (capital letters, colon-delimited) */
+static const char *mac_mobile_nodes = CONFIG_APP_PEER_ADDRS;
 
-/* MAC address of the Thingy:52 (capital letters, colon-delimited) */
-static const char *mac_mobile_node = "FD:26:10:55:4A:37";
 
-/* Re-usable write-params (filled in send_message) */
-static struct bt_gatt_write_params write_params;
+/* Peer stats read: one at a time, reassembled across read-blob chunks */
+static struct bt_gatt_read_params stats_read_params;
+static uint32_t stats_buf[NUS_PERIPH_CTR_COUNT];
+static uint16_t stats_len;
+static atomic_t stats_busy;
 
 /* ────────────────────────────────────────────────────────────────
  *  Thread for BT initialisation + scanning
@@ -83,65 +102,165 @@ static uint8_t notify_func(struct bt_conn *conn,
                            struct bt_gatt_subscribe_params *params,
                            const void *data, uint16_t length)
 {
+    uint32_t rx_us = nus_timestamp_us();
+
     if (!data || length == 0) {
         return BT_GATT_ITER_CONTINUE;
     }
 
+    uint8_t src = bt_conn_index(conn);
+
+    /* Clock probes are answered here, not via the queue, so queueing
+     * delay never leaks into the offset estimate */
+    if (((const uint8_t *)data)[0] == NUS_FRAME_PONG &&
+        length >= sizeof(struct nus_pong_frame)) {
+        struct nus_pong_frame pong;
+        memcpy(&pong, data, sizeof(pong));
+        latency_on_pong(src, &pong, rx_us);
+        return BT_GATT_ITER_CONTINUE;
+    }
+    /* Only the primary link was sent any requests */
+    if (src != atomic_get(&primary) &&
+        (((const uint8_t *)data)[0] == NUS_FRAME_ACK ||
+         ((const uint8_t *)data)[0] == NUS_FRAME_LOG)) {
+        return BT_GATT_ITER_CONTINUE;
+    }
+    if (((const uint8_t *)data)[0] == NUS_FRAME_ACK &&
+        length >= sizeof(struct nus_ack_frame)) {
+        struct nus_ack_frame ack;
+        memcpy(&ack, data, sizeof(ack));
+        command_on_ack(&ack);
+        return BT_GATT_ITER_CONTINUE;
+    }
+    /* Log chunks fill the MTU, too big for a bt_msgq entry */
+    if (((const uint8_t *)data)[0] == NUS_FRAME_LOG) {
+        log_relay_chunk(data, length);
+        return BT_GATT_ITER_CONTINUE;
+    }
+    /* Audio has its own queue, so it never counts as pitch backlog */
+    if (((const uint8_t *)data)[0] == NUS_FRAME_AUDIO) {
+        audio_relay_packet(data, length);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    loss_stats_inc(CTR_NOTIFY_RX);
+    if (length > BLE_CHUNK_DATA_LEN) {
+        loss_stats_inc(CTR_NOTIFY_TRUNCATED);
+    }
+
     bt_msg_t msg;
+    msg.rx_us = rx_us;
+    msg.src   = src;
     msg.len = MIN(length, BLE_CHUNK_DATA_LEN);
     memcpy(msg.data, data, msg.len);          /* no NUL terminator */
 
     if (k_msgq_put(&bt_msgq, &msg, K_NO_WAIT) != 0) {
-        printk("BLE-MSGQ full, dropped notification\n");
+        loss_stats_inc(CTR_MSGQ_FULL);
     }
 
     return BT_GATT_ITER_CONTINUE;
 }
 
 /* ────────────────────────────────────────────────────────────────
- *  Write-completion debug helper
+ *  API called from main.c
  * ────────────────────────────────────────────────────────────── */
-static void write_complete_cb(struct bt_conn *conn,
-                              uint8_t err,
-                              struct bt_gatt_write_params *params)
+bool bluetooth_link_ready(uint8_t link)
 {
-    printk("bt_gatt_write %s (err=%u)\n",
-           err ? "FAILED" : "OK", err);
+    return link < CONFIG_BT_MAX_CONN && links[link].conn &&
+           links[link].discovery_complete;
 }
 
-/* ────────────────────────────────────────────────────────────────
- *  API called from main.c
- * ────────────────────────────────────────────────────────────── */
-void send_message(const char *msg)
+int send_message_to(uint8_t link, const void *data, uint16_t len)
 {
-    if (!default_conn || !discovery_complete) {
-        printk("send_message: link not ready\n");
-        return;
+    if (!bluetooth_link_ready(link)) {
+        loss_stats_inc(CTR_WRITE_NOT_READY);
+        return -ENOTCONN;
+    }
+
+    /* Write-without-response: no shared params, safe from any thread */
+    int err = bt_gatt_write_without_response(links[link].conn,
+                                             links[link].nus_rx_handle,
+                                             data, len, false);
+    if (err) {
+        loss_stats_inc(CTR_WRITE_ERRORS);
+    }
+    return err;
+}
+
+int send_message_nr(const void *data, uint16_t len)
+{
+    atomic_val_t link = atomic_get(&primary);
+
+    if (link < 0) {
+        loss_stats_inc(CTR_WRITE_NOT_READY);
+        return -ENOTCONN;
     }
+    return send_message_to(link, data, len);
+}
 
-    write_params.handle = nus_rx_handle;
-    write_params.offset = 0;
-    write_params.data   = (const uint8_t *)msg;
-    write_params.length = strlen(msg);
-    write_params.func   = write_complete_cb;
+static uint8_t stats_read_cb(struct bt_conn *conn, uint8_t err,
+                             struct bt_gatt_read_params *params,
+                             const void *data, uint16_t length)
+{
+    if (!err && data) {
+        /* Long value: called once per chunk, then once with data == NULL */
+        uint16_t n = MIN(length, sizeof(stats_buf) - stats_len);
+        memcpy((uint8_t *)stats_buf + stats_len, data, n);
+        stats_len += n;
+        return BT_GATT_ITER_CONTINUE;
+    }
 
-    int err = bt_gatt_write(default_conn, &write_params);
-    printk("bt_gatt_write -> %d\n", err);
+    if (err) {
+        printk("peer stats read failed (att 0x%02x)\n", err);
+    } else if (stats_len < sizeof(stats_buf)) {
+        printk("peer stats short (%u of %u bytes)\n",
+               stats_len, (unsigned)sizeof(stats_buf));
+    } else {
+        loss_stats_peer(stats_buf);
+    }
+    atomic_clear(&stats_busy);
+    return BT_GATT_ITER_STOP;
 }
 
-void send_messagef(const char *fmt, ...)
+int read_peer_stats(void)
 {
-    char buf[64];
+    atomic_val_t link = atomic_get(&primary);
+
+    if (link < 0 || !bluetooth_link_ready(link)) {
+        return -ENOTCONN;
+    }
+    if (!links[link].stats_handle) {
+        return -ENOTSUP;            /* peripheral firmware without stats */
+    }
+    if (!atomic_cas(&stats_busy, 0, 1)) {
+        return -EBUSY;
+    }
 
-    va_list ap;
-    va_start(ap, fmt);
-    int len = vsnprintf(buf, sizeof(buf), fmt, ap);
-    va_end(ap);
+    stats_len = 0;
+    memset(&stats_read_params, 0, sizeof(stats_read_params));
+    stats_read_params.func          = stats_read_cb;
+    stats_read_params.handle_count  = 1;
+    stats_read_params.single.handle = links[link].stats_handle;
+    stats_read_params.single.offset = 0;
 
-    if (len <= 0) { return; }
-    if (len >= sizeof(buf)) { buf[sizeof(buf)-1] = '\0'; }
+    int err = bt_gatt_read(links[link].conn, &stats_read_params);
+    if (err) {
+        atomic_clear(&stats_busy);
+    }
+    return err;
+}
 
-    send_message(buf);
+/* ────────────────────────────────────────────────────────────────
+ *  The primary link: the first one ready, or the next after it drops
+ * ────────────────────────────────────────────────────────────── */
+static void claim_primary(uint8_t link)
+{
+    if (!atomic_cas(&primary, -1, link)) {
+        return;
+    }
+    printk("Link %u carries commands\n", link);
+    subscription_link_up();
+    log_relay_link_up();
 }
 
 /* ────────────────────────────────────────────────────────────────
@@ -151,42 +270,45 @@ static uint8_t discover_func(struct bt_conn *conn,
                              const struct bt_gatt_attr *attr,
                              struct bt_gatt_discover_params *params)
 {
+    struct link *l = &links[bt_conn_index(conn)];
+
     /* ── Phase finished (attr == NULL) – kick off the next one ── */
     if (!attr) {
         switch (params->type) {
 
         case BT_GATT_DISCOVER_PRIMARY: {
-            memset(&disc, 0, sizeof(disc));
-            disc.uuid         = NULL;                        /* all chrcs */
-            disc.start_handle = svc_start_handle + 1;
-            disc.end_handle   = svc_end_handle;
-            disc.type         = BT_GATT_DISCOVER_CHARACTERISTIC;
-            disc.func         = discover_func;
-            bt_gatt_discover(conn, &disc);
+            memset(&l->disc, 0, sizeof(l->disc));
+            l->disc.uuid         = NULL;                        /* all chrcs */
+            l->disc.start_handle = l->svc_start_handle + 1;
+            l->disc.end_handle   = l->svc_end_handle;
+            l->disc.type         = BT_GATT_DISCOVER_CHARACTERISTIC;
+            l->disc.func         = discover_func;
+            bt_gatt_discover(conn, &l->disc);
             break;
         }
 
         case BT_GATT_DISCOVER_CHARACTERISTIC: {
-            if (!tx_handle) {
+            if (!l->tx_handle) {
                 printk("No NUS-TX found – discovery aborted\n");
                 return BT_GATT_ITER_STOP;
             }
-            memset(&disc, 0, sizeof(disc));
-            disc.uuid         = NULL;                        /* all descr */
-            disc.start_handle = tx_handle + 1;
-            disc.end_handle   = svc_end_handle;
-            disc.type         = BT_GATT_DISCOVER_DESCRIPTOR;
-            disc.func         = discover_func;
-            bt_gatt_discover(conn, &disc);
+            memset(&l->disc, 0, sizeof(l->disc));
+            l->disc.uuid         = NULL;                        /* all descr */
+            l->disc.start_handle = l->tx_handle + 1;
+            l->disc.end_handle   = l->svc_end_handle;
+            l->disc.type         = BT_GATT_DISCOVER_DESCRIPTOR;
+            l->disc.func         = discover_func;
+            bt_gatt_discover(conn, &l->disc);
             break;
         }
 
         case BT_GATT_DISCOVER_DESCRIPTOR: {
-            discovery_complete = true;
+            l->discovery_complete = true;
             printk("Discovery complete – RX=0x%04x "
                    "TX=0x%04x CCC=0x%04x\n",
-                   nus_rx_handle, tx_handle,
-                   subscribe_params.ccc_handle);
+                   l->nus_rx_handle, l->tx_handle,
+                   l->subscribe_params.ccc_handle);
+            claim_primary(bt_conn_index(conn));
             break;
         }
         }
@@ -198,10 +320,10 @@ static uint8_t discover_func(struct bt_conn *conn,
 
     case BT_GATT_DISCOVER_PRIMARY: {
         const struct bt_gatt_service_val *sv = attr->user_data;
-        svc_start_handle = attr->handle;
-        svc_end_handle   = sv->end_handle;
+        l->svc_start_handle = attr->handle;
+        l->svc_end_handle   = sv->end_handle;
         printk("Found NUS service 0x%04x–0x%04x\n",
-               svc_start_handle, svc_end_handle);
+               l->svc_start_handle, l->svc_end_handle);
         return BT_GATT_ITER_CONTINUE;
     }
 
@@ -209,18 +331,22 @@ static uint8_t discover_func(struct bt_conn *conn,
         const struct bt_gatt_chrc *chrc = attr->user_data;
 
         if (!bt_uuid_cmp(chrc->uuid, &rx_uuid.uuid)) {
-            nus_rx_handle = chrc->value_handle;
-            printk("Found NUS-RX @ 0x%04x\n", nus_rx_handle);
+            l->nus_rx_handle = chrc->value_handle;
+            printk("Found NUS-RX @ 0x%04x\n", l->nus_rx_handle);
         }
         else if (!bt_uuid_cmp(chrc->uuid, &tx_uuid.uuid)) {
-            tx_handle = chrc->value_handle;
+            l->tx_handle = chrc->value_handle;
             printk("Found NUS-TX @ 0x%04x (props=0x%02x)\n",
-                   tx_handle, chrc->properties);
+                   l->tx_handle, chrc->properties);
 
-            memset(&subscribe_params, 0, sizeof(subscribe_params));
-            subscribe_params.notify       = notify_func;
-            subscribe_params.value_handle = tx_handle;
-            subscribe_params.value        = BT_GATT_CCC_NOTIFY;
+            memset(&l->subscribe_params, 0, sizeof(l->subscribe_params));
+            l->subscribe_params.notify       = notify_func;
+            l->subscribe_params.value_handle = l->tx_handle;
+            l->subscribe_params.value        = BT_GATT_CCC_NOTIFY;
+        }
+        else if (!bt_uuid_cmp(chrc->uuid, &stats_uuid.uuid)) {
+            l->stats_handle = chrc->value_handle;
+            printk("Found stats @ 0x%04x\n", l->stats_handle);
         }
         return BT_GATT_ITER_CONTINUE;
     }
@@ -228,10 +354,10 @@ static uint8_t discover_func(struct bt_conn *conn,
     case BT_GATT_DISCOVER_DESCRIPTOR: {
         /* Only act on the 0x2902 CCC descriptor */
         if (!bt_uuid_cmp(attr->uuid, BT_UUID_GATT_CCC)) {
-            subscribe_params.ccc_handle = attr->handle;
-            int err = bt_gatt_subscribe(conn, &subscribe_params);
+            l->subscribe_params.ccc_handle = attr->handle;
+            int err = bt_gatt_subscribe(conn, &l->subscribe_params);
             printk("bt_gatt_subscribe -> %d (CCC=0x%04x)\n",
-                   err, subscribe_params.ccc_handle);
+                   err, l->subscribe_params.ccc_handle);
         }
         /* keep iterating until attr == NULL so Zephyr writes 0x0001 */
         return BT_GATT_ITER_CONTINUE;
@@ -246,56 +372,79 @@ static uint8_t discover_func(struct bt_conn *conn,
  * ────────────────────────────────────────────────────────────── */
 static void start_discovery(struct bt_conn *conn)
 {
-    discovery_complete = false;
-    nus_rx_handle      = 0;
-    tx_handle          = 0;
-
-    memset(&disc, 0, sizeof(disc));
-    disc.uuid         = &svc_uuid.uuid;
-    disc.start_handle = BT_ATT_FIRST_ATTRIBUTE_HANDLE;
-    disc.end_handle   = BT_ATT_LAST_ATTRIBUTE_HANDLE;
-    disc.type         = BT_GATT_DISCOVER_PRIMARY;
-    disc.func         = discover_func;
-
-    int err = bt_gatt_discover(conn, &disc);
+    struct link *l = &links[bt_conn_index(conn)];
+
+    l->discovery_complete = false;
+    l->nus_rx_handle      = 0;
+    l->tx_handle          = 0;
+    l->stats_handle       = 0;
+
+    memset(&l->disc, 0, sizeof(l->disc));
+    l->disc.uuid         = &svc_uuid.uuid;
+    l->disc.start_handle = BT_ATT_FIRST_ATTRIBUTE_HANDLE;
+    l->disc.end_handle   = BT_ATT_LAST_ATTRIBUTE_HANDLE;
+    l->disc.type         = BT_GATT_DISCOVER_PRIMARY;
+    l->disc.func         = discover_func;
+
+    int err = bt_gatt_discover(conn, &l->disc);
     printk("bt_gatt_discover (PRIMARY) -> %d\n", err);
 }
 
 /* ────────────────────────────────────────────────────────────────
- *  Passive scanner – connect to the matching MAC
+ *  Passive scanner – connect to every listed MAC, one link each
  * ────────────────────────────────────────────────────────────── */
+static bool slot_free(void)
+{
+    for (int i = 0; i < CONFIG_BT_MAX_CONN; i++) {
+        if (!links[i].conn) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static void device_found(const bt_addr_le_t *addr, int8_t rssi,
                          uint8_t type, struct net_buf_simple *ad)
 {
-    if (default_conn ||
+    if (!slot_free() ||
         (type != BT_HCI_ADV_IND && type != BT_HCI_ADV_DIRECT_IND)) {
-        return;                       /* already connected / not connectable */
+        return;                       /* no room / not connectable */
     }
 
     char addr_str[BT_ADDR_LE_STR_LEN];
     bt_addr_le_to_str(addr, addr_str, sizeof(addr_str));
+    addr_str[BT_ADDR_STR_LEN - 1] = '\0';   /* drop the " (random)" */
 
-    if (strncmp(addr_str, mac_mobile_node,
-                strlen(mac_mobile_node)) != 0) {
-        return;                       /* not our peripheral */
+    if (!strstr(mac_mobile_nodes, addr_str)) {
+        return;                       /* not one of our peripherals */
+    }
+
+    struct bt_conn *conn = bt_conn_lookup_addr_le(BT_ID_DEFAULT, addr);
+    if (conn) {
+        bt_conn_unref(conn);
+        return;                       /* already connected */
     }
 
     printk("Found peripheral %s (RSSI %d), connecting…\n",
            addr_str, rssi);
     bt_le_scan_stop();
 
+    /* Open on NUS_LINK_BALANCED's window; the peripheral asks for the
+     * profile it wants once discovery is done */
     int err = bt_conn_le_create(addr, BT_CONN_LE_CREATE_CONN,
-                                BT_LE_CONN_PARAM_DEFAULT,
-                                &default_conn);
+                                BT_LE_CONN_PARAM(24, 40, 0, 400),
+                                &conn);
     if (err) {
         printk("bt_conn_le_create failed (%d) – restarting scan\n", err);
-        default_conn = NULL;
         start_scan();
+        return;
     }
+    /* The slot keeps the create reference until the link drops */
+    links[bt_conn_index(conn)].conn = conn;
 }
 
 /* ────────────────────────────────────────────────────────────────
- *  Start or restart scanning
+ *  Start or restart scanning while a slot is free
  * ────────────────────────────────────────────────────────────── */
 static void start_scan(void)
 {
@@ -305,40 +454,103 @@ static void start_scan(void)
         .interval = BT_GAP_SCAN_FAST_INTERVAL,
         .window   = BT_GAP_SCAN_FAST_WINDOW,
     };
-    bt_le_scan_start(&param, device_found);
-    printk("Scanning for Thingy:52…\n");
+
+    if (!slot_free()) {
+        return;
+    }
+    /* -EALREADY when another slot was already being scanned for */
+    if (bt_le_scan_start(&param, device_found) == 0) {
+        printk("Scanning for Thingy:52…\n");
+    }
 }
 
 /* ────────────────────────────────────────────────────────────────
  *  Connection callbacks
  * ────────────────────────────────────────────────────────────── */
+static void mtu_exchanged(struct bt_conn *conn, uint8_t err,
+                          struct bt_gatt_exchange_params *params)
+{
+    printk("ATT MTU %u (%s)\n", bt_gatt_get_mtu(conn),
+           err ? "exchange failed" : "exchanged");
+}
+
 static void connected_cb(struct bt_conn *conn, uint8_t err)
 {
+    uint8_t      idx = bt_conn_index(conn);
+    struct link *l   = &links[idx];
+
     if (err) {
         printk("Connection failed (%u)\n", err);
+        if (l->conn) {
+            bt_conn_unref(l->conn);
+            l->conn = NULL;
+        }
         start_scan();
         return;
     }
 
-    printk("Connected – starting discovery\n");
-    default_conn = bt_conn_ref(conn);
-    start_discovery(default_conn);
+    printk("Connected link %u – starting discovery\n", idx);
+    loss_stats_link_reset(idx);
+    latency_link_reset(idx);
+    /* Room for full-size pitch log chunks */
+    l->mtu_params.func = mtu_exchanged;
+    bt_gatt_exchange_mtu(conn, &l->mtu_params);
+    start_discovery(conn);
+    /* Keep looking for the other peripherals */
+    start_scan();
 }
 
 static void disconnected_cb(struct bt_conn *conn, uint8_t reason)
 {
-    printk("Disconnected (reason 0x%02x)\n", reason);
+    uint8_t      idx = bt_conn_index(conn);
+    struct link *l   = &links[idx];
 
-    if (default_conn) {
-        bt_conn_unref(default_conn);
-        default_conn = NULL;
+    printk("Disconnected link %u (reason 0x%02x)\n", idx, reason);
+
+    if (l->conn) {
+        bt_conn_unref(l->conn);
+        l->conn = NULL;
+    }
+    l->discovery_complete = false;
+
+    if (atomic_cas(&primary, idx, -1)) {
+        atomic_clear(&stats_busy);
+        command_link_down();
+        log_relay_link_down();
+        /* Hand commands to a link that is still up */
+        for (int i = 0; i < CONFIG_BT_MAX_CONN; i++) {
+            if (bluetooth_link_ready(i)) {
+                claim_primary(i);
+                break;
+            }
+        }
     }
     start_scan();
 }
 
+static void le_param_updated_cb(struct bt_conn *conn, uint16_t interval,
+                                uint16_t latency, uint16_t timeout)
+{
+    printk("Link interval %u.%02u ms, latency %u, timeout %u ms\n",
+           interval * 125 / 100, interval * 125 % 100, latency,
+           timeout * 10);
+}
+
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+static void le_phy_updated_cb(struct bt_conn *conn,
+                              struct bt_conn_le_phy_info *param)
+{
+    printk("Link PHY tx 0x%02x rx 0x%02x\n", param->tx_phy, param->rx_phy);
+}
+#endif
+
 BT_CONN_CB_DEFINE(conn_callbacks) = {
-    .connected    = connected_cb,
-    .disconnected = disconnected_cb,
+    .connected        = connected_cb,
+    .disconnected     = disconnected_cb,
+    .le_param_updated = le_param_updated_cb,
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+    .le_phy_updated   = le_phy_updated_cb,
+#endif
 };
 
 /* ────────────────────────────────────────────────────────────────
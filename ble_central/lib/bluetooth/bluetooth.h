@@ -5,10 +5,32 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
 
-/** Send a NUL-terminated string to the peripheral’s RX characteristic */
-void send_message(const char *msg);
+/** Up to CONFIG_BT_MAX_CONN peripherals, each on the link numbered by
+ *  its bt_conn_index(). The first one to finish discovery is the
+ *  primary link: commands, acks, log uploads and stats reads use it
+ *  alone, and the next ready link takes over when it drops. */
+
+/** Connected and discovered */
+bool bluetooth_link_ready(uint8_t link);
+
+/** Raw write-without-response to one link's RX; -ENOTCONN while that
+ *  link is down */
+int send_message_to(uint8_t link, const void *data, uint16_t len);
+
+/** Raw write-without-response to the primary link's RX; -ENOTCONN while
+ *  there is none. Commands go through command_send() (lib/command)
+ *  instead, which frames, acknowledges and retries them. */
+int send_message_nr(const void *data, uint16_t len);
+
+/** Read the primary peripheral's loss counters; printed when the read
+ *  completes */
+int read_peer_stats(void);
+
+/** Spawn the thread that enables BT and starts scanning */
+void bluetooth_thread_start(void);
 
 #ifdef __cplusplus
 }
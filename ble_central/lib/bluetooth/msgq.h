@@ -3,7 +3,7 @@
 
 #include <zephyr/kernel.h>
 
-#define BLE_CHUNK_DATA_LEN 19    /* max raw bytes per notification */
+#define BLE_CHUNK_DATA_LEN 20    /* max raw bytes per notification */
 #define MSGQ_MAX_MSGS      64    /* increase depth to avoid drops */
 #define MSGQ_ALIGN         4
 
@@ -11,6 +11,8 @@
 typedef struct {
     uint8_t  data[BLE_CHUNK_DATA_LEN];
     uint16_t len;
+    uint32_t rx_us;                /* nus_timestamp_us() in notify_func */
+    uint8_t  src;                  /* bt_conn_index() of the sender */
 } bt_msg_t;
 
 /* Exported queue from main.c */
@@ -0,0 +1,167 @@
+/* lib/command/command.c
+ *
+ * Request IDs, in-flight tracking and retries for peripheral commands.
+ */
+
+#include "command.h"
+#include "bluetooth.h"
+#include "loss_stats.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+struct request {
+    bool     used;
+    uint8_t  retries;
+    uint8_t  len;
+    int64_t  sent_ms;               /* last (re)transmission */
+    int64_t  first_ms;
+    uint8_t  buf[NUS_MAX_PAYLOAD];  /* nus_req_hdr + command */
+};
+
+static struct request inflight[CMD_MAX_INFLIGHT];
+static uint8_t next_id;
+
+/* inflight[] is shared by callers, the BT RX thread (acks) and the
+ * system work queue (retries); writes happen outside the lock */
+static struct k_spinlock lock;
+
+static void retry_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(retry_work, retry_handler);
+
+static inline uint8_t req_id(const struct request *r)
+{
+    return r->buf[offsetof(struct nus_req_hdr, req_id)];
+}
+
+static inline uint8_t req_cmd(const struct request *r)
+{
+    return r->buf[sizeof(struct nus_req_hdr)];
+}
+
+int command_send(const void *cmd, uint16_t len)
+{
+    uint8_t op = ((const uint8_t *)cmd)[0];
+    uint8_t out[NUS_MAX_PAYLOAD];
+    struct request *r = NULL;
+
+    if (len == 0 || len > NUS_REQ_MAX_CMD) {
+        return -EMSGSIZE;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    for (int i = 0; i < CMD_MAX_INFLIGHT; i++) {
+        if (inflight[i].used && req_cmd(&inflight[i]) == op) {
+            r = &inflight[i];       /* superseded */
+            break;
+        }
+        if (!inflight[i].used && !r) {
+            r = &inflight[i];
+        }
+    }
+    if (!r) {
+        k_spin_unlock(&lock, key);
+        return -EBUSY;
+    }
+
+    struct nus_req_hdr hdr = { .type = NUS_REQ, .req_id = next_id++ };
+    memcpy(r->buf, &hdr, sizeof(hdr));
+    memcpy(r->buf + sizeof(hdr), cmd, len);
+    r->used     = true;
+    r->retries  = 0;
+    r->len      = sizeof(hdr) + len;
+    r->sent_ms  = k_uptime_get();
+    r->first_ms = r->sent_ms;
+    memcpy(out, r->buf, r->len);
+    uint8_t n = r->len;
+    k_spin_unlock(&lock, key);
+
+    int err = send_message_nr(out, n);
+    if (err == -ENOTCONN) {
+        key = k_spin_lock(&lock);
+        if (r->used && req_id(r) == hdr.req_id) {
+            r->used = false;
+        }
+        k_spin_unlock(&lock, key);
+        return err;
+    }
+
+    /* Anything else (no TX buffer right now) is left to the retry */
+    k_work_schedule(&retry_work, K_MSEC(CMD_RETRY_MS));
+    return 0;
+}
+
+void command_on_ack(const struct nus_ack_frame *ack)
+{
+    int64_t rtt_ms = -1;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    for (int i = 0; i < CMD_MAX_INFLIGHT; i++) {
+        if (inflight[i].used && req_id(&inflight[i]) == ack->req_id) {
+            inflight[i].used = false;
+            rtt_ms = k_uptime_get() - inflight[i].first_ms;
+            break;
+        }
+    }
+    k_spin_unlock(&lock, key);
+
+    /* Acks for superseded requests still report a rejection */
+    if (ack->status) {
+        printk("Command '%c' #%u rejected (%d)\n",
+               ack->cmd, ack->req_id, ack->status);
+    } else if (rtt_ms > CMD_RETRY_MS) {
+        printk("Command '%c' #%u acknowledged after %lld ms\n",
+               ack->cmd, ack->req_id, rtt_ms);
+    }
+}
+
+void command_link_down(void)
+{
+    k_work_cancel_delayable(&retry_work);
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    for (int i = 0; i < CMD_MAX_INFLIGHT; i++) {
+        inflight[i].used = false;
+    }
+    k_spin_unlock(&lock, key);
+}
+
+static void retry_handler(struct k_work *work)
+{
+    int64_t now = k_uptime_get();
+    bool waiting = false;
+
+    for (int i = 0; i < CMD_MAX_INFLIGHT; i++) {
+        struct request *r = &inflight[i];
+        uint8_t out[NUS_MAX_PAYLOAD];
+        uint8_t n = 0;
+
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        if (r->used && now - r->sent_ms >= CMD_RETRY_MS) {
+            if (r->retries == CMD_RETRIES) {
+                r->used = false;
+                loss_stats_inc(CTR_CMD_LOST);
+                printk("Command '%c' #%u not acknowledged\n",
+                       req_cmd(r), req_id(r));
+            } else {
+                r->retries++;
+                r->sent_ms = now;
+                memcpy(out, r->buf, r->len);
+                n = r->len;
+            }
+        }
+        waiting |= r->used;
+        k_spin_unlock(&lock, key);
+
+        if (n) {
+            loss_stats_inc(CTR_CMD_RETRIES);
+            send_message_nr(out, n);
+        }
+    }
+
+    if (waiting) {
+        k_work_schedule(&retry_work, K_MSEC(CMD_RETRY_MS / 2));
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <stdint.h>
+#include "nus_proto.h"
+
+/* Acknowledged commands to the peripheral.
+ *
+ * Each command struct goes out as a single write-without-response
+ * behind a nus_req_hdr, so it needs only one connection event and no
+ * shared GATT write state. Up to CMD_MAX_INFLIGHT requests may await
+ * their nus_ack_frame at once; any still unacknowledged after
+ * CMD_RETRY_MS is resent, up to CMD_RETRIES times. A command whose
+ * opcode is already in flight replaces that request, so the newest
+ * mode switch or config push always wins and a retry never brings back
+ * an older one.
+ *
+ * Safe to call from any thread.
+ */
+#define CMD_MAX_INFLIGHT 4
+#define CMD_RETRY_MS     250
+#define CMD_RETRIES      3
+
+/* 0 once sent (acknowledgement pending); -ENOTCONN while the link is
+ * down, -EMSGSIZE if cmd does not fit a request, -EBUSY with every
+ * slot awaiting an ack */
+int command_send(const void *cmd, uint16_t len);
+
+/* notify_func(): an ack arrived */
+void command_on_ack(const struct nus_ack_frame *ack);
+
+/* Link dropped: forget everything in flight */
+void command_link_down(void);
+
+#endif /* COMMAND_H */
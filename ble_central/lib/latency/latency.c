@@ -0,0 +1,293 @@
+/* lib/latency/latency.c
+ *
+ * Per-stage latency histograms plus a ping/pong clock-offset estimator
+ * between each connected Thingy:52 and the base node. Exposed as
+ * `latency` on the shell.
+ */
+
+#include "latency.h"
+#include "bluetooth.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#include <errno.h>
+#include <string.h>
+
+/* ────────────────────────────────────────────────────────────────
+ *  Tuning
+ * ────────────────────────────────────────────────────────────── */
+#define LAT_PING_PERIOD_MS 1000
+#define LAT_OFFSET_WINDOW  8     /* pongs kept for min-RTT selection */
+#define LAT_HIST_BUCKETS   16    /* log2 buckets starting at 128 us  */
+#define LAT_HIST_SHIFT     7     /* bucket 0 = [0, 128) us           */
+
+struct lat_stats {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t hist[LAT_HIST_BUCKETS];
+};
+
+struct lat_sample {
+    uint32_t rtt_us;
+    int32_t  offset_us;    /* peripheral clock - central clock */
+};
+
+static const char *const stage_names[LAT_STAGE_COUNT] = {
+    [LAT_CAPTURE] = "capture",
+    [LAT_DSP]     = "dsp",
+    [LAT_BLE]     = "ble",
+    [LAT_QUEUE]   = "queue",
+    [LAT_TOTAL]   = "total",
+};
+
+/* Every peripheral runs its own clock */
+struct lat_clock {
+    struct lat_sample samples[LAT_OFFSET_WINDOW];
+    uint8_t  head;
+    uint8_t  count;
+    int32_t  offset_us;
+    uint32_t rtt_us;
+    bool     synced;
+};
+
+static struct lat_stats stats[LAT_STAGE_COUNT];
+static struct lat_clock clocks[CONFIG_BT_MAX_CONN];
+
+static struct k_spinlock lock;
+
+static void ping_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(ping_work, ping_work_handler);
+
+/* ────────────────────────────────────────────────────────────────
+ *  Histogram helpers
+ * ────────────────────────────────────────────────────────────── */
+static uint8_t bucket_of(uint32_t us)
+{
+    uint32_t v = us >> LAT_HIST_SHIFT;
+    uint8_t  b = (v == 0) ? 0 : (uint8_t)(32 - __builtin_clz(v));
+
+    return MIN(b, LAT_HIST_BUCKETS - 1);
+}
+
+static void stats_add(enum lat_stage stage, uint32_t us)
+{
+    struct lat_stats *s = &stats[stage];
+
+    if (s->count == 0 || us < s->min_us) {
+        s->min_us = us;
+    }
+    if (us > s->max_us) {
+        s->max_us = us;
+    }
+    s->count++;
+    s->sum_us += us;
+    s->hist[bucket_of(us)]++;
+}
+
+/* ────────────────────────────────────────────────────────────────
+ *  Clock offset (NTP-style, keep the lowest-RTT sample in the window)
+ * ────────────────────────────────────────────────────────────── */
+static void ping_work_handler(struct k_work *work)
+{
+    for (uint8_t i = 0; i < CONFIG_BT_MAX_CONN; i++) {
+        struct nus_ping_cmd ping = {
+            .cmd          = NUS_CMD_PING,
+            .t_central_us = nus_timestamp_us(),
+        };
+
+        if (bluetooth_link_ready(i)) {
+            send_message_to(i, &ping, sizeof(ping));
+        }
+    }
+    k_work_reschedule(&ping_work, K_MSEC(LAT_PING_PERIOD_MS));
+}
+
+void latency_link_reset(uint8_t src)
+{
+    if (src >= CONFIG_BT_MAX_CONN) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    memset(&clocks[src], 0, sizeof(clocks[src]));
+    k_spin_unlock(&lock, key);
+}
+
+void latency_on_pong(uint8_t src, const struct nus_pong_frame *pong,
+                     uint32_t rx_us)
+{
+    uint32_t rtt = rx_us - pong->t_central_us;
+    int32_t  offset = (int32_t)(pong->t_periph_us -
+                                (pong->t_central_us + rtt / 2));
+
+    if (src >= CONFIG_BT_MAX_CONN) {
+        return;
+    }
+    struct lat_clock *c = &clocks[src];
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    c->samples[c->head] = (struct lat_sample){ rtt, offset };
+    c->head  = (c->head + 1) % LAT_OFFSET_WINDOW;
+    c->count = MIN(c->count + 1, LAT_OFFSET_WINDOW);
+
+    const struct lat_sample *best = &c->samples[0];
+    for (uint8_t i = 1; i < c->count; i++) {
+        if (c->samples[i].rtt_us < best->rtt_us) {
+            best = &c->samples[i];
+        }
+    }
+    c->offset_us = best->offset_us;
+    c->rtt_us    = best->rtt_us;
+    c->synced    = true;
+
+    k_spin_unlock(&lock, key);
+}
+
+/* ────────────────────────────────────────────────────────────────
+ *  Per-frame accounting
+ * ────────────────────────────────────────────────────────────── */
+void latency_record(uint8_t src, const struct nus_pitch_frame *frame,
+                    uint32_t rx_us, uint32_t parsed_us)
+{
+    const struct lat_clock *c = src < CONFIG_BT_MAX_CONN ? &clocks[src]
+                                                         : NULL;
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    uint32_t dsp_start_us = frame->t_dsp_end_us - frame->dsp_us;
+
+    stats_add(LAT_CAPTURE, dsp_start_us - frame->t_capture_us);
+    stats_add(LAT_DSP,     frame->dsp_us);
+    stats_add(LAT_QUEUE,   parsed_us - rx_us);
+
+    if (c && c->synced) {
+        uint32_t sent_us    = frame->t_dsp_end_us - c->offset_us;
+        uint32_t capture_us = frame->t_capture_us - c->offset_us;
+
+        stats_add(LAT_BLE,   rx_us - sent_us);
+        stats_add(LAT_TOTAL, parsed_us - capture_us);
+    }
+
+    k_spin_unlock(&lock, key);
+}
+
+int latency_to_local(uint8_t src, uint32_t periph_us, uint32_t *local_us)
+{
+    if (src >= CONFIG_BT_MAX_CONN) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool synced = clocks[src].synced;
+    *local_us = periph_us - clocks[src].offset_us;
+    k_spin_unlock(&lock, key);
+
+    return synced ? 0 : -EAGAIN;
+}
+
+void latency_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    memset(stats, 0, sizeof(stats));
+    k_spin_unlock(&lock, key);
+}
+
+void latency_summary(enum lat_stage stage, struct lat_summary *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    const struct lat_stats *s = &stats[stage];
+
+    out->count  = s->count;
+    out->min_us = s->count ? s->min_us : 0;
+    out->max_us = s->max_us;
+    out->avg_us = s->count ? (uint32_t)(s->sum_us / s->count) : 0;
+    k_spin_unlock(&lock, key);
+}
+
+void latency_init(void)
+{
+    k_work_reschedule(&ping_work, K_MSEC(LAT_PING_PERIOD_MS));
+}
+
+/* ────────────────────────────────────────────────────────────────
+ *  Shell
+ * ────────────────────────────────────────────────────────────── */
+static int cmd_latency_show(const struct shell *sh, size_t argc, char **argv)
+{
+    struct lat_stats snap[LAT_STAGE_COUNT];
+    struct lat_clock clk[CONFIG_BT_MAX_CONN];
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    memcpy(snap, stats, sizeof(snap));
+    memcpy(clk, clocks, sizeof(clk));
+    k_spin_unlock(&lock, key);
+
+    for (int i = 0; i < CONFIG_BT_MAX_CONN; i++) {
+        if (clk[i].synced) {
+            shell_print(sh, "link %d clock offset %d us (rtt %u us)", i,
+                        clk[i].offset_us, clk[i].rtt_us);
+        } else {
+            shell_print(sh, "link %d clock offset: not synced, "
+                        "ble/total pending", i);
+        }
+    }
+
+    shell_print(sh, "%-8s %8s %10s %10s %10s",
+                "stage", "count", "min ms", "avg ms", "max ms");
+    for (int i = 0; i < LAT_STAGE_COUNT; i++) {
+        const struct lat_stats *s = &snap[i];
+        double avg = s->count ? (double)s->sum_us / s->count : 0.0;
+
+        shell_print(sh, "%-8s %8u %10.2f %10.2f %10.2f",
+                    stage_names[i], s->count,
+                    s->min_us / 1000.0, avg / 1000.0, s->max_us / 1000.0);
+    }
+    return 0;
+}
+
+static int cmd_latency_hist(const struct shell *sh, size_t argc, char **argv)
+{
+    struct lat_stats snap[LAT_STAGE_COUNT];
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    memcpy(snap, stats, sizeof(snap));
+    k_spin_unlock(&lock, key);
+
+    for (int i = 0; i < LAT_STAGE_COUNT; i++) {
+        shell_print(sh, "%s:", stage_names[i]);
+        for (int b = 0; b < LAT_HIST_BUCKETS; b++) {
+            if (snap[i].hist[b] == 0) {
+                continue;
+            }
+            uint32_t lo = (b == 0) ? 0 : (1U << (LAT_HIST_SHIFT + b - 1));
+            uint32_t hi = 1U << (LAT_HIST_SHIFT + b);
+            if (b == LAT_HIST_BUCKETS - 1) {
+                shell_print(sh, "  >= %7u us  %u", lo, snap[i].hist[b]);
+            } else {
+                shell_print(sh, "  < %8u us  %u", hi, snap[i].hist[b]);
+            }
+        }
+    }
+    return 0;
+}
+
+static int cmd_latency_reset(const struct shell *sh, size_t argc, char **argv)
+{
+    latency_reset();
+    shell_print(sh, "latency stats cleared");
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(latency_cmds,
+    SHELL_CMD(show,  NULL, "Per-stage min/avg/max", cmd_latency_show),
+    SHELL_CMD(hist,  NULL, "Per-stage log2 histogram", cmd_latency_hist),
+    SHELL_CMD(reset, NULL, "Clear all stats", cmd_latency_reset),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(latency, &latency_cmds,
+                   "Capture -> DSP -> BLE -> queue latency", NULL);
@@ -0,0 +1,56 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include "nus_proto.h"
+
+/* End-to-end latency tracing, pluck -> reading on the base node.
+ *
+ *   capture : dmic_read() returned        -> DSP claimed the block
+ *   dsp     : DSP claimed the block       -> pitch frame handed to BLE
+ *   ble     : handed to BLE (peripheral)  -> notify_func() (central)
+ *   queue   : notify_func()               -> main() finished parsing
+ *
+ * capture/dsp are measured on the peripheral clock and queue on ours, so
+ * they need no synchronisation. ble (and total) cross clocks and are only
+ * recorded once a ping/pong offset estimate exists. Each connection
+ * (src, its bt_conn_index()) keeps its own offset.
+ */
+enum lat_stage {
+    LAT_CAPTURE,
+    LAT_DSP,
+    LAT_BLE,
+    LAT_QUEUE,
+    LAT_TOTAL,
+    LAT_STAGE_COUNT
+};
+
+struct lat_summary {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t avg_us;
+    uint32_t max_us;
+};
+
+/* Start the periodic clock-offset ping */
+void latency_init(void);
+
+/* New connection on src: forget the previous peer's offset */
+void latency_link_reset(uint8_t src);
+
+/* Pong arrived in notify_func(); rx_us is our clock at arrival */
+void latency_on_pong(uint8_t src, const struct nus_pong_frame *pong,
+                     uint32_t rx_us);
+
+/* Account one pitch frame once main() has parsed it */
+void latency_record(uint8_t src, const struct nus_pitch_frame *frame,
+                    uint32_t rx_us, uint32_t parsed_us);
+
+/* src's timestamp -> our clock; -EAGAIN until its offset is known */
+int latency_to_local(uint8_t src, uint32_t periph_us, uint32_t *local_us);
+
+void latency_reset(void);
+
+void latency_summary(enum lat_stage stage, struct lat_summary *out);
+
+#endif /* LATENCY_H */
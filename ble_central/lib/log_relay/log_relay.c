@@ -0,0 +1,285 @@
+/* lib/log_relay/log_relay.c
+ *
+ * Pitch log uploads from the peripheral, credit flow control and the
+ * `pitchlog` shell command.
+ */
+
+#include "log_relay.h"
+#include "command.h"
+#include "loss_stats.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/printk.h>
+
+#define RELAY_STACK_SIZE 1024
+#define RELAY_PRIORITY   10         /* below main() and data fusion */
+
+/* Re-grant credit this often while an upload waits on it, in case the
+ * grant could not be sent */
+#define CREDIT_RETRY_MS  250
+
+struct log_chunk {
+    uint16_t len;
+    uint8_t  data[NUS_LOG_CHUNK_MAX];
+};
+
+K_MSGQ_DEFINE(log_chunk_q, sizeof(struct log_chunk), LOG_RELAY_DEPTH, 4);
+
+/* Started from the shell or the work queue, advanced by the relay
+ * thread, checked in notify_func() */
+static struct k_spinlock lock;
+static bool     active;
+static bool     keep;
+static uint16_t expected;           /* next chunk number */
+static uint16_t granted;            /* last credit limit sent */
+static uint32_t records;
+static uint32_t lost;
+
+/* notify_func() scratch, BT RX thread only */
+static struct log_chunk rx;
+
+int log_relay_upload(bool keep_log)
+{
+    k_msgq_purge(&log_chunk_q);
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    active   = true;
+    keep     = keep_log;
+    expected = 0;
+    granted  = LOG_RELAY_DEPTH;
+    records  = 0;
+    lost     = 0;
+    k_spin_unlock(&lock, key);
+
+    printk("LOG BEGIN\n");
+    struct nus_log_cmd cmd = {
+        .cmd = NUS_CMD_LOG,
+        .op  = NUS_LOG_OP_UPLOAD,
+        .arg = LOG_RELAY_DEPTH,
+    };
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        key = k_spin_lock(&lock);
+        active = false;
+        k_spin_unlock(&lock, key);
+        printk("LOG END upload not sent (%d)\n", err);
+    }
+    return err;
+}
+
+void log_relay_chunk(const uint8_t *data, uint16_t len)
+{
+    if (len < sizeof(struct nus_log_chunk_hdr)) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool on = active;
+    k_spin_unlock(&lock, key);
+    if (!on) {
+        return;
+    }
+
+    rx.len = MIN(len, sizeof(rx.data));
+    memcpy(rx.data, data, rx.len);
+    if (k_msgq_put(&log_chunk_q, &rx, K_NO_WAIT) != 0) {
+        loss_stats_inc(CTR_LOG_QUEUE_FULL);
+    }
+}
+
+static void auto_upload_handler(struct k_work *work)
+{
+    log_relay_upload(false);
+}
+
+static K_WORK_DEFINE(auto_upload_work, auto_upload_handler);
+
+void log_relay_link_up(void)
+{
+    /* Whatever piled up while the link was down comes over first */
+    if (IS_ENABLED(CONFIG_APP_LOG_AUTO_UPLOAD)) {
+        k_work_submit(&auto_upload_work);
+    }
+}
+
+void log_relay_link_down(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool was = active;
+    active = false;
+    k_spin_unlock(&lock, key);
+
+    if (was) {
+        printk("LOG END aborted, link down\n");
+    }
+}
+
+/* Let the peripheral run ahead by the room left in the queue; only
+ * worth a request once half the queue has been freed */
+static void grant_credit(void)
+{
+    uint16_t room  = LOG_RELAY_DEPTH - k_msgq_num_used_get(&log_chunk_q);
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint16_t limit = expected + room;
+    bool due = active &&
+               (int16_t)(limit - granted) >= LOG_RELAY_DEPTH / 2;
+    k_spin_unlock(&lock, key);
+    if (!due) {
+        return;
+    }
+
+    struct nus_log_credit_cmd cmd = {
+        .cmd   = NUS_CMD_LOG_CREDIT,
+        .limit = limit,
+    };
+    if (command_send(&cmd, sizeof(cmd)) == 0) {
+        key = k_spin_lock(&lock);
+        granted = limit;
+        k_spin_unlock(&lock, key);
+    }
+}
+
+static void finish(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    active = false;
+    uint32_t n      = records;
+    uint32_t missed = lost;
+    bool     hold   = keep;
+    k_spin_unlock(&lock, key);
+
+    printk("LOG END records=%u lost=%u\n", n, missed);
+    if (missed || hold) {
+        /* Leave it on the peripheral for another try */
+        return;
+    }
+
+    struct nus_log_cmd cmd = {
+        .cmd = NUS_CMD_LOG,
+        .op  = NUS_LOG_OP_COMMIT,
+    };
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        printk("Log commit not sent (%d)\n", err);
+    }
+}
+
+static void print_chunk(const struct log_chunk *c)
+{
+    struct nus_log_chunk_hdr hdr;
+    memcpy(&hdr, c->data, sizeof(hdr));
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint16_t gap = hdr.seq - expected;
+    bool fresh = active && (int16_t)gap >= 0;
+    if (fresh) {
+        lost    += gap;
+        expected = hdr.seq + 1;
+    }
+    k_spin_unlock(&lock, key);
+    if (!fresh) {
+        return;
+    }
+    for (uint16_t i = 0; i < gap; i++) {
+        loss_stats_inc(CTR_LOG_CHUNKS_LOST);
+    }
+
+    uint16_t n = (c->len - sizeof(hdr)) / sizeof(struct nus_log_record);
+    for (uint16_t i = 0; i < n; i++) {
+        struct nus_log_record rec;
+        memcpy(&rec, &c->data[sizeof(hdr) + i * sizeof(rec)], sizeof(rec));
+        printk("LOG %u %u.%03u %.2f %.*s %u\n", rec.boot,
+               rec.t_ms / 1000, rec.t_ms % 1000, (double)rec.freq_hz,
+               NUS_NOTE_LEN, rec.note, rec.confidence * 100U / 255U);
+    }
+
+    key = k_spin_lock(&lock);
+    records += n;
+    k_spin_unlock(&lock, key);
+
+    if (hdr.flags & NUS_LOG_LAST) {
+        finish();
+    }
+}
+
+static void relay_entry(void *p1, void *p2, void *p3)
+{
+    struct log_chunk c;
+
+    while (1) {
+        if (k_msgq_get(&log_chunk_q, &c, K_MSEC(CREDIT_RETRY_MS)) == 0) {
+            print_chunk(&c);
+        }
+        grant_credit();
+    }
+}
+
+K_THREAD_DEFINE(log_relay, RELAY_STACK_SIZE, relay_entry,
+                NULL, NULL, NULL, RELAY_PRIORITY, 0, 0);
+
+/* --- Shell -------------------------------------------------------- */
+
+static int send_log_op(const struct shell *shell, uint8_t op, uint16_t arg)
+{
+    struct nus_log_cmd cmd = {
+        .cmd = NUS_CMD_LOG,
+        .op  = op,
+        .arg = arg,
+    };
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        shell_print(shell, "Log request not sent (%d)", err);
+    }
+    return err;
+}
+
+static int cmd_pitchlog_upload(const struct shell *shell, size_t argc,
+                               char **argv)
+{
+    if (argc == 2 && strcmp(argv[1], "keep") != 0) {
+        shell_print(shell, "Usage: pitchlog upload [keep]");
+        return -EINVAL;
+    }
+    int err = log_relay_upload(argc == 2);
+    if (err) {
+        shell_print(shell, "Upload not started (%d)", err);
+    }
+    return err;
+}
+
+static int cmd_pitchlog_record(const struct shell *shell, size_t argc,
+                               char **argv)
+{
+    bool on = strcmp(argv[1], "on") == 0;
+    if (!on && strcmp(argv[1], "off") != 0) {
+        shell_print(shell, "Usage: pitchlog record <on|off>");
+        return -EINVAL;
+    }
+    return send_log_op(shell, NUS_LOG_OP_RECORD, on);
+}
+
+static int cmd_pitchlog_erase(const struct shell *shell, size_t argc,
+                              char **argv)
+{
+    return send_log_op(shell, NUS_LOG_OP_ERASE, 0);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(pitchlog_cmds,
+    SHELL_CMD_ARG(upload, NULL,
+                  "[keep] fetch the peripheral's pitch log; keep leaves "
+                  "it in flash afterwards",
+                  cmd_pitchlog_upload, 1, 1),
+    SHELL_CMD_ARG(record, NULL,
+                  "<on|off> log every reported result, not just the "
+                  "undelivered ones",
+                  cmd_pitchlog_record, 2, 0),
+    SHELL_CMD(erase,      NULL, "Drop the peripheral's pitch log",
+              cmd_pitchlog_erase),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(pitchlog, &pitchlog_cmds,
+                   "Store-and-forward pitch log on the peripheral", NULL);
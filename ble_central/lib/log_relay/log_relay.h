@@ -0,0 +1,39 @@
+#ifndef LOG_RELAY_H
+#define LOG_RELAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "nus_proto.h"
+
+/* Pulls the peripheral's store-and-forward pitch log (NUS_FRAME_LOG)
+ * and prints it on the console, one line per record:
+ *
+ *   LOG BEGIN
+ *   LOG <boot> <uptime s> <Hz> <note> <confidence %>
+ *
+ * Uptime restarts with every peripheral boot; <boot> counts them, so
+ * (boot, uptime) orders records across resets.
+ *   LOG END records=<n> lost=<chunks>
+ *
+ * Chunks are queued straight from notify_func() (they are larger than
+ * a bt_msgq entry) and printed by a low-priority thread. Credits sent
+ * back as the queue drains keep a slow console from overrunning it,
+ * so the upload runs at whatever the link and the console sustain.
+ * An upload that arrives complete is committed, which frees the
+ * peripheral's flash, unless it was started with keep.
+ *
+ * Also provides the `pitchlog` shell command.
+ */
+#define LOG_RELAY_DEPTH 8
+
+/* Any thread: start an upload */
+int  log_relay_upload(bool keep);
+
+/* notify_func(): one NUS_FRAME_LOG notification */
+void log_relay_chunk(const uint8_t *data, uint16_t len);
+
+/* Discovery done / link dropped */
+void log_relay_link_up(void);
+void log_relay_link_down(void);
+
+#endif /* LOG_RELAY_H */
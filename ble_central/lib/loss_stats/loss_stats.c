@@ -0,0 +1,129 @@
+/* lib/loss_stats/loss_stats.c
+ *
+ * Drop counters for the base node plus the `stats` shell command.
+ */
+
+#include "loss_stats.h"
+#include "bluetooth.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+
+static atomic_t ctr[CENTRAL_CTR_COUNT];
+
+#define CTR_NAME(id, name) [id] = name,
+static const char *const names[CENTRAL_CTR_COUNT] = {
+    CENTRAL_COUNTERS(CTR_NAME)
+};
+static const char *const peer_names[NUS_PERIPH_CTR_COUNT] = {
+    NUS_PERIPH_COUNTERS(CTR_NAME)
+};
+#undef CTR_NAME
+
+/* One sequence run per connection. Only main() calls loss_stats_seq();
+ * connected_cb() just raises the link's flag. */
+struct seq_state {
+    uint16_t last;
+    bool     have;
+    atomic_t restart;
+};
+
+static struct seq_state seq_state[CONFIG_BT_MAX_CONN];
+
+void loss_stats_inc(enum central_ctr id)
+{
+    atomic_inc(&ctr[id]);
+}
+
+uint32_t loss_stats_get(enum central_ctr id)
+{
+    return (uint32_t)atomic_get(&ctr[id]);
+}
+
+void loss_stats_link_reset(uint8_t src)
+{
+    if (src < CONFIG_BT_MAX_CONN) {
+        atomic_set(&seq_state[src].restart, 1);
+    }
+}
+
+void loss_stats_seq(uint8_t src, uint16_t seq)
+{
+    atomic_inc(&ctr[CTR_PITCH_RX]);
+
+    if (src >= CONFIG_BT_MAX_CONN) {
+        return;
+    }
+    struct seq_state *st = &seq_state[src];
+
+    if (atomic_cas(&st->restart, 1, 0)) {
+        st->have = false;
+    }
+    if (!st->have) {
+        st->have = true;
+        st->last = seq;
+        return;
+    }
+
+    uint16_t ahead = seq - (uint16_t)(st->last + 1);
+    if (ahead < 0x8000) {
+        atomic_add(&ctr[CTR_SEQ_LOST], ahead);
+        st->last = seq;
+    } else {
+        atomic_inc(&ctr[CTR_SEQ_OLD]);
+    }
+}
+
+void loss_stats_peer(const uint32_t peer[NUS_PERIPH_CTR_COUNT])
+{
+    printk("peripheral:\n");
+    for (int i = 0; i < NUS_PERIPH_CTR_COUNT; i++) {
+        printk("  %-40s %u\n", peer_names[i], peer[i]);
+    }
+}
+
+/* ────────────────────────────────────────────────────────────────
+ *  Shell
+ * ────────────────────────────────────────────────────────────── */
+static int cmd_stats_show(const struct shell *sh, size_t argc, char **argv)
+{
+    shell_print(sh, "base node:");
+    for (int i = 0; i < CENTRAL_CTR_COUNT; i++) {
+        shell_print(sh, "  %-40s %u", names[i],
+                    (uint32_t)atomic_get(&ctr[i]));
+    }
+    return 0;
+}
+
+static int cmd_stats_peer(const struct shell *sh, size_t argc, char **argv)
+{
+    int err = read_peer_stats();
+    if (err) {
+        shell_print(sh, "peer stats read failed (%d)", err);
+    }
+    return err;
+}
+
+static int cmd_stats_reset(const struct shell *sh, size_t argc, char **argv)
+{
+    for (int i = 0; i < CENTRAL_CTR_COUNT; i++) {
+        atomic_clear(&ctr[i]);
+    }
+    for (uint8_t i = 0; i < CONFIG_BT_MAX_CONN; i++) {
+        loss_stats_link_reset(i);
+    }
+    shell_print(sh, "base node counters cleared");
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(stats_cmds,
+    SHELL_CMD(show,  NULL, "Base node drop counters", cmd_stats_show),
+    SHELL_CMD(peer,  NULL, "Read the peripheral's counters", cmd_stats_peer),
+    SHELL_CMD(reset, NULL, "Clear base node counters", cmd_stats_reset),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(stats, &stats_cmds,
+                   "Where frames are lost, capture -> DSP -> BLE -> main", NULL);
@@ -0,0 +1,51 @@
+#ifndef LOSS_STATS_H
+#define LOSS_STATS_H
+
+#include <stdint.h>
+#include "nus_proto.h"
+
+/* Where notifications and commands go missing on the base node.
+ *
+ * The counters cover every drop point between the radio and main():
+ * oversized notifications, a full bt_msgq, and GATT writes that fail.
+ * Pitch-frame sequence gaps measure the end-to-end loss, so
+ *   seq gaps = peripheral notify errors + msgq drops here.
+ * `stats peer` reads the peripheral's own counters over GATT.
+ */
+#define CENTRAL_COUNTERS(X)                                             \
+    X(CTR_NOTIFY_RX,        "notifications received")                   \
+    X(CTR_NOTIFY_TRUNCATED, "notifications truncated to chunk size")    \
+    X(CTR_MSGQ_FULL,        "notifications dropped, bt_msgq full")      \
+    X(CTR_PITCH_RX,         "pitch frames parsed")                      \
+    X(CTR_SEQ_LOST,         "pitch frames missing (seq gaps)")          \
+    X(CTR_SEQ_OLD,          "pitch frames duplicate/out of order")      \
+    X(CTR_WRITE_NOT_READY,  "writes refused, link not ready")           \
+    X(CTR_WRITE_ERRORS,     "GATT write errors")                        \
+    X(CTR_SPECTRUM_DROPPED, "spectra dropped, chunk missing")           \
+    X(CTR_CMD_RETRIES,      "commands resent, no ack yet")              \
+    X(CTR_CMD_LOST,         "commands never acknowledged")              \
+    X(CTR_LOG_QUEUE_FULL,   "log chunks dropped, relay queue full")     \
+    X(CTR_LOG_CHUNKS_LOST,  "log chunks missing (seq gaps)")            \
+    X(CTR_AUDIO_QUEUE_FULL, "audio packets dropped, relay queue full")
+
+#define CENTRAL_CTR_ID(id, name) id,
+enum central_ctr {
+    CENTRAL_COUNTERS(CENTRAL_CTR_ID)
+    CENTRAL_CTR_COUNT
+};
+#undef CENTRAL_CTR_ID
+
+void loss_stats_inc(enum central_ctr id);
+uint32_t loss_stats_get(enum central_ctr id);
+
+/* Track the pitch-frame sequence number once main() has parsed it;
+ * src is the sender's bt_conn_index(), each link has its own run */
+void loss_stats_seq(uint8_t src, uint16_t seq);
+
+/* New connection on src: its next sequence number starts a fresh run */
+void loss_stats_link_reset(uint8_t src);
+
+/* Peripheral counters from the stats characteristic */
+void loss_stats_peer(const uint32_t ctr[NUS_PERIPH_CTR_COUNT]);
+
+#endif /* LOSS_STATS_H */
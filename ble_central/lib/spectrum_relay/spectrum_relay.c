@@ -0,0 +1,80 @@
+/* lib/spectrum_relay/spectrum_relay.c
+ *
+ * Spectrum chunk reassembly and console forwarding.
+ */
+
+#include "spectrum_relay.h"
+#include "loss_stats.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#define PAYLOAD_MAX (NUS_SPEC_MAX_CHUNKS * NUS_SPEC_CHUNK_DATA)
+
+static uint8_t  payload[PAYLOAD_MAX];
+static size_t   payload_len;
+static uint8_t  cur_seq;
+static uint8_t  cur_flags;
+static uint8_t  cur_chunks;
+static uint16_t got_mask;               /* chunks received, 0 = idle */
+
+/* "SPEC 255 ff " + two hex digits per byte + NUL */
+static char line[16 + 2 * PAYLOAD_MAX];
+
+static void forward(void)
+{
+    static const char hex[] = "0123456789abcdef";
+    int n = snprintk(line, sizeof(line), "SPEC %u %02x ", cur_seq, cur_flags);
+
+    for (size_t i = 0; i < payload_len; i++) {
+        line[n++] = hex[payload[i] >> 4];
+        line[n++] = hex[payload[i] & 0x0F];
+    }
+    line[n] = '\0';
+    printk("%s\n", line);
+}
+
+void spectrum_relay_chunk(const uint8_t *data, uint16_t len)
+{
+    struct nus_spec_chunk_hdr hdr;
+    if (len <= sizeof(hdr)) {
+        return;
+    }
+    memcpy(&hdr, data, sizeof(hdr));
+    data += sizeof(hdr);
+    len  -= sizeof(hdr);
+
+    uint8_t idx    = hdr.part >> 4;
+    uint8_t chunks = (hdr.part & 0x0F) + 1;
+
+    if (got_mask != 0 && hdr.seq != cur_seq) {
+        /* the previous spectrum never completed */
+        loss_stats_inc(CTR_SPECTRUM_DROPPED);
+        got_mask = 0;
+    }
+    if (got_mask == 0) {
+        cur_seq     = hdr.seq;
+        cur_flags   = hdr.flags;
+        cur_chunks  = chunks;
+        payload_len = 0;
+    }
+    if (idx >= cur_chunks || chunks != cur_chunks ||
+        (idx + 1 < chunks && len != NUS_SPEC_CHUNK_DATA)) {
+        loss_stats_inc(CTR_SPECTRUM_DROPPED);
+        got_mask = 0;
+        return;
+    }
+
+    size_t off = idx * NUS_SPEC_CHUNK_DATA;
+    memcpy(&payload[off], data, MIN(len, NUS_SPEC_CHUNK_DATA));
+    got_mask |= BIT(idx);
+    if (idx + 1 == chunks) {
+        payload_len = off + len;
+    }
+
+    if (got_mask == BIT_MASK(cur_chunks)) {
+        forward();
+        got_mask = 0;
+    }
+}
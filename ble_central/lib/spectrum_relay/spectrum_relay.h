@@ -0,0 +1,18 @@
+#ifndef SPECTRUM_RELAY_H
+#define SPECTRUM_RELAY_H
+
+#include <stdint.h>
+#include "nus_proto.h"
+
+/* Reassembles NUS_FRAME_SPECTRUM chunks and forwards each complete
+ * spectrum on the console as one line for scripts/spectrum_view.py:
+ *
+ *   SPEC <seq> <flags hex> <payload hex>
+ *
+ * The payload is still delta coded (see nus_proto.h); decoding is the
+ * host's job. Spectra with a missing chunk are dropped and counted.
+ * Only main() calls spectrum_relay_chunk().
+ */
+void spectrum_relay_chunk(const uint8_t *data, uint16_t len);
+
+#endif /* SPECTRUM_RELAY_H */
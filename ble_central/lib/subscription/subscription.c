@@ -0,0 +1,141 @@
+/* lib/subscription/subscription.c
+ *
+ * Rate/detail requests to the peripheral, the queue-driven rate backoff
+ * and the `subscribe` shell command.
+ */
+
+#include "subscription.h"
+#include "command.h"
+#include "msgq.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/printk.h>
+
+/* bt_msgq fill levels that slow the stream down or let it speed up */
+#define QUEUE_HIGH        (MSGQ_MAX_MSGS * 3 / 4)
+#define QUEUE_LOW         (MSGQ_MAX_MSGS / 8)
+/* Let a change reach the queue before judging it */
+#define CHANGE_HOLDOFF_MS 1000
+
+static uint16_t wanted_dhz = NUS_RATE_DEFAULT_DHZ;
+static uint16_t active_dhz = NUS_RATE_DEFAULT_DHZ;
+static uint8_t  detail     = NUS_DETAIL_TRACE;
+static uint32_t last_change_ms;
+
+/* Written from the shell and main(), sent from the system work queue */
+static struct k_spinlock lock;
+
+static void send_handler(struct k_work *work)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    struct nus_subscribe_cmd cmd = {
+        .cmd      = NUS_CMD_SUBSCRIBE,
+        .rate_dhz = active_dhz,
+        .detail   = detail,
+    };
+    k_spin_unlock(&lock, key);
+
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        printk("Subscribe not sent (%d)\n", err);
+        return;
+    }
+    printk("Subscribed %u.%u frames/s, %s\n", cmd.rate_dhz / 10,
+           cmd.rate_dhz % 10,
+           cmd.detail == NUS_DETAIL_TRACE ? "trace" : "basic");
+}
+
+static K_WORK_DEFINE(send_work, send_handler);
+
+void subscription_link_up(void)
+{
+    /* A fresh link starts from what the user asked for */
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    active_dhz     = wanted_dhz;
+    last_change_ms = k_uptime_get_32();
+    k_spin_unlock(&lock, key);
+
+    k_work_submit(&send_work);
+}
+
+void subscription_backpressure(uint32_t queued)
+{
+    uint32_t now = k_uptime_get_32();
+    bool changed = false;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (now - last_change_ms >= CHANGE_HOLDOFF_MS) {
+        uint16_t next = active_dhz;
+
+        if (queued >= QUEUE_HIGH) {
+            next = MAX(active_dhz / 2, NUS_RATE_MIN_DHZ);
+        } else if (queued <= QUEUE_LOW && active_dhz < wanted_dhz) {
+            next = MIN(active_dhz * 2, wanted_dhz);
+        }
+        if (next != active_dhz) {
+            active_dhz     = next;
+            last_change_ms = now;
+            changed        = true;
+        }
+    }
+    k_spin_unlock(&lock, key);
+
+    if (changed) {
+        k_work_submit(&send_work);
+    }
+}
+
+static int subscribe_cmd(const struct shell *shell, size_t argc, char **argv)
+{
+    if (argc == 1) {
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        uint16_t want = wanted_dhz, active = active_dhz;
+        uint8_t  d = detail;
+        k_spin_unlock(&lock, key);
+
+        shell_print(shell, "wanted %u.%u frames/s, requested %u.%u, %s",
+                    want / 10, want % 10, active / 10, active % 10,
+                    d == NUS_DETAIL_TRACE ? "trace" : "basic");
+        return 0;
+    }
+
+    uint8_t d;
+    if (argc == 3 && strcmp(argv[2], "basic") == 0) {
+        d = NUS_DETAIL_BASIC;
+    } else if (argc == 3 && strcmp(argv[2], "trace") == 0) {
+        d = NUS_DETAIL_TRACE;
+    } else {
+        shell_print(shell, "Usage:");
+        shell_print(shell, "  subscribe                        show the current request");
+        shell_print(shell, "  subscribe <rate_hz> <basic|trace>  e.g. subscribe 2.5 basic");
+        return -EINVAL;
+    }
+
+    char *end;
+    float hz = strtof(argv[1], &end);
+    long dhz = lroundf(hz * 10.0f);
+    if (*end != '\0' || dhz < NUS_RATE_MIN_DHZ || dhz > NUS_RATE_MAX_DHZ) {
+        shell_print(shell, "Rate must be %u.%u..%u Hz: %s",
+                    NUS_RATE_MIN_DHZ / 10, NUS_RATE_MIN_DHZ % 10,
+                    NUS_RATE_MAX_DHZ / 10, argv[1]);
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    wanted_dhz     = (uint16_t)dhz;
+    active_dhz     = wanted_dhz;
+    detail         = d;
+    last_change_ms = k_uptime_get_32();
+    k_spin_unlock(&lock, key);
+
+    k_work_submit(&send_work);
+    return 0;
+}
+
+SHELL_CMD_REGISTER(subscribe, NULL,
+                   "Sets the peripheral's frame rate and detail level",
+                   subscribe_cmd);
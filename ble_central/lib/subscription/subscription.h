@@ -0,0 +1,22 @@
+#ifndef SUBSCRIPTION_H
+#define SUBSCRIPTION_H
+
+#include <stdint.h>
+#include "nus_proto.h"
+
+/* What the base node asks the peripheral to stream.
+ *
+ * `subscribe <rate_hz> <basic|trace>` sets the wanted rate and detail.
+ * While bt_msgq backs up the rate actually requested is halved, and it
+ * climbs back towards the wanted rate once main() has caught up. The
+ * request is re-sent whenever the link comes up, since the peripheral
+ * falls back to its defaults on every connection.
+ */
+
+/* GATT discovery finished: push the current request to the peripheral */
+void subscription_link_up(void);
+
+/* Called by main() after each message with the bt_msgq fill level */
+void subscription_backpressure(uint32_t queued);
+
+#endif /* SUBSCRIPTION_H */
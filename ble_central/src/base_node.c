@@ -0,0 +1,133 @@
+/* src/base_node.c
+ *
+ * Parses pitch notifications from the peripherals and feeds them into
+ * data_fusion as confidence-weighted, time-aligned readings.
+ */
+
+#include "base_node.h"
+#include "data_fusion.h"
+#include "latency.h"
+#include "loss_stats.h"
+#include "spectrum_relay.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+/* Trace frames carry no confidence: they already passed the
+ * peripheral's gate. Legacy text frames were never gated. */
+#define TRACE_CONFIDENCE  1.0f
+#define LEGACY_CONFIDENCE 0.5f
+
+static int  periph_source[CONFIG_BT_MAX_CONN];
+static char periph_name[CONFIG_BT_MAX_CONN][8];
+
+static void print_reading(uint8_t instrument, const struct fusion_output *out)
+{
+    char inst[16] = "";
+    if (instrument != 0) {
+        snprintf(inst, sizeof(inst), " (instrument %u)", instrument);
+    }
+
+    /* Lite frames carry the peripheral's confidence and SNR */
+    if (out->snr_db != FUSION_SNR_UNKNOWN) {
+        printk("%.2f %.*s conf %u%% snr %d dB%s\n", (double)out->freq_hz,
+               NUS_NOTE_LEN, out->note,
+               (unsigned)(out->confidence * 100.0f + 0.5f), out->snr_db,
+               inst);
+    } else {
+        printk("%.2f %.*s%s\n", (double)out->freq_hz, NUS_NOTE_LEN,
+               out->note, inst);
+    }
+}
+
+void base_node_init(void)
+{
+    for (int i = 0; i < CONFIG_BT_MAX_CONN; i++) {
+        periph_source[i] = -1;
+    }
+    fusion_start(print_reading);
+}
+
+static int source_for(uint8_t conn_idx)
+{
+    if (conn_idx >= CONFIG_BT_MAX_CONN) {
+        return -1;
+    }
+    if (periph_source[conn_idx] < 0) {
+        snprintf(periph_name[conn_idx], sizeof(periph_name[conn_idx]),
+                 "periph%u", conn_idx);
+        periph_source[conn_idx] = fusion_source_add(periph_name[conn_idx], 0);
+    }
+    return periph_source[conn_idx];
+}
+
+/* Best guess at when a frame without timestamps was captured: arrival
+ * less the mean capture-to-parse latency measured so far */
+static uint32_t capture_estimate(uint32_t rx_us)
+{
+    struct lat_summary total;
+    latency_summary(LAT_TOTAL, &total);
+    return rx_us - total.avg_us;
+}
+
+void base_node_handle(const bt_msg_t *msg, uint32_t parsed_us)
+{
+    struct fusion_sample sample = { .snr_db = FUSION_SNR_UNKNOWN };
+
+    if (msg->data[0] == NUS_FRAME_SPECTRUM) {
+        spectrum_relay_chunk(msg->data, msg->len);
+        return;
+    }
+    if (msg->data[0] == NUS_FRAME_PITCH_LITE &&
+        msg->len >= sizeof(struct nus_pitch_lite_frame)) {
+        struct nus_pitch_lite_frame frame;
+        memcpy(&frame, msg->data, sizeof(frame));
+        loss_stats_seq(msg->src, frame.seq);
+
+        sample.freq_hz    = frame.freq_hz;
+        sample.confidence = frame.confidence / 255.0f;
+        sample.snr_db     = frame.snr_db;
+        sample.t_us       = capture_estimate(msg->rx_us);
+        memcpy(sample.note, frame.note, NUS_NOTE_LEN);
+    } else if (msg->data[0] == NUS_FRAME_PITCH &&
+               msg->len >= sizeof(struct nus_pitch_frame)) {
+        struct nus_pitch_frame frame;
+        memcpy(&frame, msg->data, sizeof(frame));
+        latency_record(msg->src, &frame, msg->rx_us, parsed_us);
+        loss_stats_seq(msg->src, frame.seq);
+
+        sample.freq_hz    = frame.freq_hz;
+        sample.confidence = TRACE_CONFIDENCE;
+        if (latency_to_local(msg->src, frame.t_capture_us,
+                             &sample.t_us) != 0) {
+            sample.t_us = capture_estimate(msg->rx_us);
+        }
+        memcpy(sample.note, frame.note, NUS_NOTE_LEN);
+    } else {
+        /* Legacy ASCII frame: "440.00 A4" */
+        char text[BLE_CHUNK_DATA_LEN + 1];
+        memcpy(text, msg->data, msg->len);
+        text[msg->len] = '\0';
+
+        char *endp;
+        sample.freq_hz = strtof(text, &endp);
+        while (isspace((unsigned char)*endp)) { ++endp; }
+
+        size_t i = 0;
+        while (i < 2 && *endp && !isspace((unsigned char)*endp)) {
+            sample.note[i++] = *endp++;
+        }
+        if (i == 0) {
+            printk("Malformed frame: '%.*s'\n", msg->len, msg->data);
+            return;
+        }
+        sample.confidence = LEGACY_CONFIDENCE;
+        sample.t_us       = capture_estimate(msg->rx_us);
+    }
+
+    fusion_submit(source_for(msg->src), &sample);
+}
@@ -0,0 +1,21 @@
+#ifndef BASE_NODE_H
+#define BASE_NODE_H
+
+#include "msgq.h"
+
+/* Base node: turns bt_msgq traffic into fusion inputs.
+ *
+ * Every peripheral becomes a fusion source the first time it sends a
+ * pitch frame, all on instrument 0 until remapped with `fusion map`.
+ * Frames are accounted (sequence, latency) and time-aligned to our
+ * clock here; the readings themselves come out of the fusion module at
+ * its own fixed rate.
+ */
+
+/* Start fusion with the base node's output (one line per reading) */
+void base_node_init(void);
+
+/* One message from bt_msgq, parsed at parsed_us */
+void base_node_handle(const bt_msg_t *msg, uint32_t parsed_us);
+
+#endif /* BASE_NODE_H */
@@ -0,0 +1,273 @@
+/* src/data_fusion.c
+ *
+ * Confidence- and age-weighted pitch fusion, run at a fixed rate on its
+ * own work queue, plus the `fusion` shell command.
+ */
+
+#include "data_fusion.h"
+#include "kalman.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/printk.h>
+
+#define FUSION_PERIOD_MS   CONFIG_APP_FUSION_PERIOD_MS
+/* A reading counts e^-1 as much once it is this old */
+#define FUSION_TAU_US      200000
+/* Older readings are ignored; an instrument with none goes quiet */
+#define FUSION_MAX_AGE_US  500000
+/* Readings this far from the strongest one are octave/string slips */
+#define OUTLIER_CENTS      100.0f
+/* A fused reading this far from the estimate is a new note */
+#define NOTE_JUMP_CENTS    50.0f
+
+#define FUSION_STACK_SIZE  1024
+#define FUSION_PRIORITY    5
+
+/* Kalman filter (1-D, Hz). Q is per period; R is per unit of weight,
+ * so several confident readings trust the measurement more. */
+static const float Q = 1e-3f;        // process noise variance
+static const float R = 1e-2f;        // measurement noise variance
+
+struct source {
+    const char          *name;
+    uint8_t              instrument;
+    bool                 fresh;      /* sample not yet fused */
+    struct fusion_sample sample;
+};
+
+struct instrument {
+    bool          active;
+    struct kalman kf;                // pitch estimate, Hz
+    uint32_t      last_us;           // last fused measurement
+    float         confidence;        // strongest reading's, held with note
+    int8_t        snr_db;
+    char          note[NUS_NOTE_LEN];
+};
+
+static struct source     sources[FUSION_MAX_SOURCES];
+static uint8_t           source_count;
+static struct instrument instruments[FUSION_MAX_INSTRUMENTS];
+static fusion_output_cb  output_cb;
+
+/* sources[] is written by submitters, read by the fusion work queue */
+static struct k_spinlock lock;
+
+static struct k_work_q fusion_q;
+static K_THREAD_STACK_DEFINE(fusion_stack, FUSION_STACK_SIZE);
+
+static void fusion_tick(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(fusion_work, fusion_tick);
+static uint32_t next_tick_ms;
+
+int fusion_source_add(const char *name, uint8_t instrument)
+{
+    if (instrument >= FUSION_MAX_INSTRUMENTS) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    int id = -ENOMEM;
+    if (source_count < FUSION_MAX_SOURCES) {
+        id = source_count++;
+        sources[id] = (struct source){
+            .name       = name,
+            .instrument = instrument,
+        };
+    }
+    k_spin_unlock(&lock, key);
+    return id;
+}
+
+int fusion_source_map(int source, uint8_t instrument)
+{
+    if (instrument >= FUSION_MAX_INSTRUMENTS) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    int err = -ENOENT;
+    if (source >= 0 && source < source_count) {
+        sources[source].instrument = instrument;
+        sources[source].fresh      = false;
+        err = 0;
+    }
+    k_spin_unlock(&lock, key);
+    return err;
+}
+
+void fusion_submit(int source, const struct fusion_sample *sample)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (source >= 0 && source < source_count) {
+        /* A burst between two periods leaves only the newest reading */
+        sources[source].sample = *sample;
+        sources[source].fresh  = true;
+    }
+    k_spin_unlock(&lock, key);
+}
+
+static float cents(float f, float ref)
+{
+    return 1200.0f * log2f(f / ref);
+}
+
+static void fuse_instrument(uint8_t inst, const struct fusion_sample *in,
+                            const float *w, uint8_t n, uint32_t now_us)
+{
+    struct instrument *ins = &instruments[inst];
+    struct fusion_output out = { 0 };
+
+    /* Weighted mean in log frequency around the strongest reading */
+    uint8_t best = 0;
+    for (uint8_t i = 1; i < n; i++) {
+        if (w[i] > w[best]) {
+            best = i;
+        }
+    }
+    float sum_w = 0.0f;
+    float sum_l = 0.0f;
+    for (uint8_t i = 0; i < n; i++) {
+        if (fabsf(cents(in[i].freq_hz, in[best].freq_hz)) > OUTLIER_CENTS) {
+            continue;
+        }
+        sum_w += w[i];
+        sum_l += w[i] * log2f(in[i].freq_hz);
+        out.sources++;
+    }
+
+    kalman_predict(&ins->kf, Q);
+    if (sum_w > 0.0f) {
+        float z = exp2f(sum_l / sum_w);
+        float r = R / sum_w;
+
+        if (!ins->active ||
+            fabsf(cents(z, ins->kf.x)) > NOTE_JUMP_CENTS) {
+            kalman_reset(&ins->kf, z, r);
+        } else {
+            kalman_update(&ins->kf, z, r);
+        }
+        ins->active  = true;
+        ins->last_us    = now_us;
+        ins->confidence = in[best].confidence;
+        ins->snr_db     = in[best].snr_db;
+        memcpy(ins->note, in[best].note, NUS_NOTE_LEN);
+    } else if (!ins->active ||
+               now_us - ins->last_us > FUSION_MAX_AGE_US) {
+        ins->active = false;
+        return;
+    }
+
+    /* Between readings the held estimate keeps the output rate steady */
+    out.freq_hz = ins->kf.x;
+    out.weight     = sum_w;
+    out.confidence = ins->confidence;
+    out.snr_db     = ins->snr_db;
+    memcpy(out.note, ins->note, NUS_NOTE_LEN);
+    if (output_cb) {
+        output_cb(inst, &out);
+    }
+}
+
+static void fusion_tick(struct k_work *work)
+{
+    struct fusion_sample in[FUSION_MAX_INSTRUMENTS][FUSION_MAX_SOURCES];
+    float   w[FUSION_MAX_INSTRUMENTS][FUSION_MAX_SOURCES];
+    uint8_t n[FUSION_MAX_INSTRUMENTS] = { 0 };
+    uint32_t now_us = nus_timestamp_us();
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    for (uint8_t s = 0; s < source_count; s++) {
+        struct source *src = &sources[s];
+        if (!src->fresh) {
+            continue;
+        }
+        src->fresh = false;
+
+        uint32_t age = now_us - src->sample.t_us;
+        if (age > FUSION_MAX_AGE_US || src->sample.confidence <= 0.0f ||
+            src->sample.freq_hz <= 0.0f) {
+            continue;
+        }
+        uint8_t inst = src->instrument;
+        in[inst][n[inst]] = src->sample;
+        w[inst][n[inst]]  = src->sample.confidence *
+                            expf(-(float)age / FUSION_TAU_US);
+        n[inst]++;
+    }
+    k_spin_unlock(&lock, key);
+
+    for (uint8_t i = 0; i < FUSION_MAX_INSTRUMENTS; i++) {
+        fuse_instrument(i, in[i], w[i], n[i], now_us);
+    }
+
+    /* Fixed rate: schedule against the ideal tick, not the late one */
+    next_tick_ms += FUSION_PERIOD_MS;
+    int32_t delay = (int32_t)(next_tick_ms - k_uptime_get_32());
+    if (delay < 0) {
+        next_tick_ms = k_uptime_get_32();
+        delay = 0;
+    }
+    k_work_reschedule_for_queue(&fusion_q, &fusion_work, K_MSEC(delay));
+}
+
+void fusion_start(fusion_output_cb cb)
+{
+    output_cb = cb;
+
+    k_work_queue_start(&fusion_q, fusion_stack,
+                       K_THREAD_STACK_SIZEOF(fusion_stack),
+                       FUSION_PRIORITY, NULL);
+    next_tick_ms = k_uptime_get_32();
+    k_work_reschedule_for_queue(&fusion_q, &fusion_work, K_NO_WAIT);
+}
+
+/* ────────────────────────────────────────────────────────────────
+ *  Shell: fusion show | fusion map <source> <instrument>
+ * ────────────────────────────────────────────────────────────── */
+static int cmd_fusion_show(const struct shell *sh, size_t argc, char **argv)
+{
+    uint32_t now_us = nus_timestamp_us();
+
+    shell_print(sh, "period %u ms, %u sources", FUSION_PERIOD_MS,
+                source_count);
+    for (uint8_t s = 0; s < source_count; s++) {
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        struct source src = sources[s];
+        k_spin_unlock(&lock, key);
+
+        shell_print(sh, "  %u %-10s inst %u  %.2f Hz conf %.2f age %u ms",
+                    s, src.name, src.instrument,
+                    (double)src.sample.freq_hz,
+                    (double)src.sample.confidence,
+                    (now_us - src.sample.t_us) / 1000U);
+    }
+    return 0;
+}
+
+static int cmd_fusion_map(const struct shell *sh, size_t argc, char **argv)
+{
+    int src  = atoi(argv[1]);
+    int inst = atoi(argv[2]);
+
+    int err = fusion_source_map(src, inst);
+    if (err) {
+        shell_print(sh, "Cannot map source %d to instrument %d (%d)",
+                    src, inst, err);
+    }
+    return err;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(fusion_cmds,
+    SHELL_CMD(show, NULL, "Pitch sources and their last reading",
+              cmd_fusion_show),
+    SHELL_CMD_ARG(map, NULL, "<source> <instrument>", cmd_fusion_map, 3, 0),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(fusion, &fusion_cmds,
+                   "Pitch fusion across sources", NULL);
@@ -0,0 +1,56 @@
+#ifndef DATA_FUSION_H
+#define DATA_FUSION_H
+
+#include <stdint.h>
+#include "nus_proto.h"
+
+/* Pitch fusion on the base node.
+ *
+ * Any number of sources (a peripheral's pitch frames, an analyser on
+ * the base node itself) feed readings for an instrument. At a fixed
+ * rate, independent of when notifications happen to arrive, every
+ * instrument's fresh readings are combined: each counts by its
+ * reported confidence and by how long ago the sound it describes was
+ * captured, readings too far from the strongest (octave slips) are
+ * left out, and the result drives that instrument's Kalman filter.
+ * A jump to another note restarts the filter instead of gliding.
+ *
+ * Sources submit from any thread; fusion and the output callback run
+ * on the fusion work queue.
+ */
+#define FUSION_MAX_SOURCES     4
+#define FUSION_MAX_INSTRUMENTS 2
+/* fusion_sample.snr_db for sources that do not measure it */
+#define FUSION_SNR_UNKNOWN     INT8_MIN
+
+struct fusion_sample {
+    float    freq_hz;
+    float    confidence;          /* 0..1 */
+    uint32_t t_us;                /* capture time, nus_timestamp_us() clock */
+    int8_t   snr_db;              /* or FUSION_SNR_UNKNOWN */
+    char     note[NUS_NOTE_LEN];
+};
+
+struct fusion_output {
+    float    freq_hz;             /* filtered */
+    float    weight;              /* sum of the contributing weights */
+    uint8_t  sources;             /* readings that contributed */
+    float    confidence;          /* these three from the strongest reading */
+    int8_t   snr_db;
+    char     note[NUS_NOTE_LEN];
+};
+
+typedef void (*fusion_output_cb)(uint8_t instrument,
+                                 const struct fusion_output *out);
+
+/* Start the fixed-rate fusion work; cb gets one call per instrument per
+ * period while it has fresh readings */
+void fusion_start(fusion_output_cb cb);
+
+/* Returns the source id, or -ENOMEM when the table is full */
+int  fusion_source_add(const char *name, uint8_t instrument);
+int  fusion_source_map(int source, uint8_t instrument);
+
+void fusion_submit(int source, const struct fusion_sample *sample);
+
+#endif /* DATA_FUSION_H */
@@ -0,0 +1,36 @@
+#ifndef KALMAN_H
+#define KALMAN_H
+
+/* One-dimensional Kalman filter on a pitch in Hz, as run per
+ * instrument by data fusion.
+ *
+ * Header-only so the kernel benchmarks in bench/ time and check the
+ * same code the base node runs.
+ */
+struct kalman {
+    float x;                /* current estimate */
+    float p;                /* estimate covariance */
+};
+
+/* Start over at measurement z of variance r */
+static inline void kalman_reset(struct kalman *k, float z, float r)
+{
+    k->x = z;
+    k->p = r;
+}
+
+/* One period passes: process noise q */
+static inline void kalman_predict(struct kalman *k, float q)
+{
+    k->p += q;
+}
+
+/* Fold in measurement z of variance r */
+static inline void kalman_update(struct kalman *k, float z, float r)
+{
+    float K = k->p / (k->p + r);
+    k->x += K * (z - k->x);
+    k->p *= (1.0f - K);
+}
+
+#endif /* KALMAN_H */
@@ -3,8 +3,17 @@
 #include <zephyr/shell/shell.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 #include "bluetooth.h"
 #include "msgq.h"
+#include "latency.h"
+#include "loss_stats.h"
+#include "subscription.h"
+#include "base_node.h"
+#include "audio_relay.h"
+#include "command.h"
+#include "nus_proto.h"
 
 #define CMD_BUFF_LEN 20
 char* note = NULL;
@@ -17,107 +26,581 @@ K_MSGQ_DEFINE(bt_msgq,
               MSGQ_MAX_MSGS,
               MSGQ_ALIGN);
 
-/* Kalman filter state (1-D) */
-static float x_est = 0.0f;    // current estimate
-static float p_est = 1.0f;    // estimate covariance
-const float Q = 1e-3f;        // process noise variance
-const float R = 1e-2f;        // measurement noise variance
-
-/* One-dimensional Kalman update */
-static float kalman_update(float z) {
-    // Predict
-    p_est += Q;
-    // Gain
-    float K = p_est / (p_est + R);
-    // Update estimate
-    x_est += K * (z - x_est);
-    // Update covariance
-    p_est *= (1.0f - K);
-    return x_est;
+/* Tuning profile presets for `tune p <preset>` */
+static const struct {
+    const char *name;
+    float       a4_hz;
+    uint8_t     count;
+    uint8_t     midi[NUS_PROFILE_MAX_STRINGS];
+} presets[] = {
+    { "std",   440.0f, 6, { 40, 45, 50, 55, 59, 64 } },     /* E2 A2 D3 G3 B3 E4 */
+    { "dropd", 440.0f, 6, { 38, 45, 50, 55, 59, 64 } },     /* D2 A2 D3 G3 B3 E4 */
+    { "half",  440.0f, 6, { 39, 44, 49, 54, 58, 63 } },     /* Eb2 .. Eb4 */
+    { "seven", 440.0f, 7, { 35, 40, 45, 50, 55, 59, 64 } }, /* B1 + standard */
+    { "orch",  442.0f, 6, { 40, 45, 50, 55, 59, 64 } },     /* standard @ A=442 */
+};
+
+/* "E2", "F#3", "Bb1" -> MIDI note number, -1 if malformed */
+static int note_to_midi(const char *s)
+{
+    static const int8_t pitch_class[7] = { 9, 11, 0, 2, 4, 5, 7 }; /* A..G */
+    char letter = toupper((unsigned char)s[0]);
+
+    if (letter < 'A' || letter > 'G') {
+        return -1;
+    }
+    int pc = pitch_class[letter - 'A'];
+    s++;
+    if (*s == '#') {
+        pc++;
+        s++;
+    } else if (*s == 'b') {
+        pc--;
+        s++;
+    }
+    if (!isdigit((unsigned char)s[0]) || s[1] != '\0') {
+        return -1;
+    }
+    return (s[0] - '0' + 1) * 12 + pc;
+}
+
+static void tune_usage(const struct shell *shell)
+{
+    shell_print(shell, "Usage:");
+    shell_print(shell, "  tune t <note>                e.g. D3, or EL|A|D|G|B|EH");
+    shell_print(shell, "  tune r");
+    shell_print(shell, "  tune p <std|dropd|half|seven|orch>");
+    shell_print(shell, "  tune p <a4_hz> <note> [note...]   e.g. tune p 440 D2 A2 D3 G3 B3 E4");
+    shell_print(shell, "  tune l <auto|fast|balanced|lowpower|range>");
+}
+
+static int send_profile(const struct shell *shell, float a4_hz,
+                        uint8_t count, const uint8_t *midi)
+{
+    struct nus_profile_cmd cmd = {
+        .cmd   = NUS_CMD_PROFILE,
+        .a4_hz = a4_hz,
+        .count = count,
+    };
+    memcpy(cmd.midi, midi, count);
+
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        shell_print(shell, "Profile not sent (%d)", err);
+        return err;
+    }
+    shell_print(shell, "Sent %u-string profile, A4=%.1f Hz", count, (double)a4_hz);
+    return 0;
+}
+
+static int tune_profile_cmd(const struct shell *shell, size_t argc, char **argv)
+{
+    if (argc == 3) {
+        for (size_t i = 0; i < ARRAY_SIZE(presets); i++) {
+            if (strcmp(argv[2], presets[i].name) == 0) {
+                return send_profile(shell, presets[i].a4_hz,
+                                    presets[i].count, presets[i].midi);
+            }
+        }
+    }
+
+    if (argc < 4 || argc - 3 > NUS_PROFILE_MAX_STRINGS) {
+        tune_usage(shell);
+        return -EINVAL;
+    }
+
+    char *end;
+    float a4 = strtof(argv[2], &end);
+    if (*end != '\0' || a4 < 400.0f || a4 > 480.0f) {
+        shell_print(shell, "Reference pitch must be 400..480 Hz: %s", argv[2]);
+        return -EINVAL;
+    }
+
+    uint8_t midi[NUS_PROFILE_MAX_STRINGS];
+    uint8_t count = argc - 3;
+    for (uint8_t i = 0; i < count; i++) {
+        int m = note_to_midi(argv[3 + i]);
+        if (m < 0) {
+            shell_print(shell, "Unknown note: %s", argv[3 + i]);
+            return -EINVAL;
+        }
+        midi[i] = m;
+    }
+    return send_profile(shell, a4, count, midi);
+}
+
+/* Link profiles for `tune l`, in enum nus_link_profile order */
+static const char *const link_names[NUS_LINK_PROFILE_COUNT] = {
+    [NUS_LINK_FAST]     = "fast",
+    [NUS_LINK_BALANCED] = "balanced",
+    [NUS_LINK_LOWPOWER] = "lowpower",
+    [NUS_LINK_RANGE]    = "range",
+};
+
+static int tune_link_cmd(const struct shell *shell, const char *name)
+{
+    struct nus_link_cmd cmd = {
+        .cmd     = NUS_CMD_LINK,
+        .profile = NUS_LINK_AUTO,
+    };
+
+    if (strcmp(name, "auto") != 0) {
+        size_t i;
+        for (i = 0; i < ARRAY_SIZE(link_names); i++) {
+            if (strcmp(name, link_names[i]) == 0) {
+                break;
+            }
+        }
+        if (i == ARRAY_SIZE(link_names)) {
+            shell_print(shell, "Unknown link profile: %s", name);
+            return -EINVAL;
+        }
+        cmd.profile = i;
+    }
+
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        shell_print(shell, "Link profile not sent (%d)", err);
+        return err;
+    }
+    shell_print(shell, "Requested %s link profile", name);
+    return 0;
 }
 
 static int tune_cmd(const struct shell *shell, size_t argc, char **argv)
 {
-    if (argc < 2 || argc > 3) {
-        shell_print(shell, "Usage:");
-        shell_print(shell, "  tune t <EL|A|D|G|B|EH>");
-        shell_print(shell, "  tune r");
-        shell_print(shell, "  tune s");
+    if (argc < 2) {
+        tune_usage(shell);
         return -EINVAL;
     }
 
     const char *mode = argv[1];
-    const char *note = argv[2];
-
-    if (strncmp(mode, "t", 1) == 0) {
-        if (strncmp(note, "EL", 2) == 0) {
-            shell_print(shell, "Sending command over bluetooth to sense for EL tune...");
-            send_messagef("t %s\n", note);
-        } else if (strncmp(note, "A", 2) == 0) {
-            shell_print(shell, "Sending command over bluetooth to sense for A tune...");
-            send_messagef("t %s\n", note);
-        } else if (strncmp(note, "D", 2) == 0) {
-            shell_print(shell, "Sending command over bluetooth to sense for D tune...");
-            send_messagef("t %s\n", note);
-        } else if (strncmp(note, "G", 2) == 0) {
-            shell_print(shell, "Sending command over bluetooth to sense for G tune...");
-            send_messagef("t %s\n", note);
-        } else if (strncmp(note, "B", 2) == 0) {
-            shell_print(shell, "Sending command over bluetooth to sense for B tune...");
-            send_messagef("t %s\n", note);
-        } else if (strncmp(note, "EH", 2) == 0) {
-            shell_print(shell, "Sending command over bluetooth to sense for EH tune...");
-            send_messagef("t %s\n", note);
-        } else {
+
+    if (strncmp(mode, "p", 1) == 0) {
+        return tune_profile_cmd(shell, argc, argv);
+    } else if (argc == 3 && strncmp(mode, "l", 1) == 0) {
+        return tune_link_cmd(shell, argv[2]);
+    }
+
+    struct nus_mode_cmd cmd = { .cmd = NUS_CMD_MODE };
+    if (argc == 3 && strncmp(mode, "t", 1) == 0) {
+        const char *note = argv[2];
+        if (strlen(note) == 0 || strlen(note) > NUS_NOTE_LEN) {
             shell_print(shell, "Unknown note: %s", note);
             return -EINVAL;
         }
+        shell_print(shell, "Sending command over bluetooth to sense for %s tune...", note);
+        cmd.mode = NUS_MODE_TUNE;
+        strncpy(cmd.note, note, NUS_NOTE_LEN);
     } else if (argc == 2 && strncmp(mode, "r", 1) == 0) {
         shell_print(shell, "Sending command to get a frequency reading...");
-        send_messagef("r\n");
-    } else if (argc == 2 && strncmp(mode, "s", 1) == 0) {
-        shell_print(shell, "Sending command to stop frequency reading...");
-        send_messagef("s\n");
+        cmd.mode = NUS_MODE_READ;
     } else {
+        tune_usage(shell);
+        return -EINVAL;
+    }
+
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        shell_print(shell, "Mode not sent (%d)", err);
+    }
+    return err;
+}
+
+SHELL_CMD_REGISTER(tune, NULL, "Sets what needs to be tuned", tune_cmd);
+
+static int report_cmd(const struct shell *shell, size_t argc, char **argv)
+{
+    if (argc != 4) {
         shell_print(shell, "Usage:");
-        shell_print(shell, "  tune t <EL|A|D|G|B|EH>");
-        shell_print(shell, "  tune r");
+        shell_print(shell, "  report <hyst_cents> <min_interval_ms> <heartbeat_ms>");
+        shell_print(shell, "  e.g. report 1.0 50 1000, report 0 0 0 = every frame");
         return -EINVAL;
     }
+
+    char *end;
+    float hyst = strtof(argv[1], &end);
+    if (*end != '\0' || hyst < 0.0f) {
+        shell_print(shell, "Bad hysteresis: %s", argv[1]);
+        return -EINVAL;
+    }
+    unsigned long min_ms = strtoul(argv[2], &end, 10);
+    if (*end != '\0') {
+        shell_print(shell, "Bad interval: %s", argv[2]);
+        return -EINVAL;
+    }
+    unsigned long hb_ms = strtoul(argv[3], &end, 10);
+    if (*end != '\0') {
+        shell_print(shell, "Bad heartbeat: %s", argv[3]);
+        return -EINVAL;
+    }
+
+    struct nus_report_cfg_cmd cmd = {
+        .cmd             = NUS_CMD_REPORT_CFG,
+        .hyst_cents      = hyst,
+        .min_interval_ms = min_ms,
+        .heartbeat_ms    = hb_ms,
+    };
+    shell_print(shell, "Sending report policy over bluetooth...");
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        shell_print(shell, "Report policy not sent (%d)", err);
+    }
+    return err;
+}
+
+SHELL_CMD_REGISTER(report, NULL,
+                   "Sets peripheral reporting hysteresis and rate limits",
+                   report_cmd);
+
+static int gate_cmd(const struct shell *shell, size_t argc, char **argv)
+{
+    if (argc != 4) {
+        shell_print(shell, "Usage:");
+        shell_print(shell, "  gate <min_snr_db> <full_snr_db> <min_confidence>");
+        shell_print(shell, "  e.g. gate 6 30 0.3, gate 0 1 0 = report every frame");
+        return -EINVAL;
+    }
+
+    char *end;
+    float v[3];
+    for (int i = 0; i < 3; i++) {
+        v[i] = strtof(argv[1 + i], &end);
+        if (*end != '\0') {
+            shell_print(shell, "Bad value: %s", argv[1 + i]);
+            return -EINVAL;
+        }
+    }
+    if (v[1] <= v[0] || v[2] < 0.0f || v[2] > 1.0f) {
+        shell_print(shell, "Need min_snr < full_snr and 0 <= min_confidence <= 1");
+        return -EINVAL;
+    }
+
+    struct nus_gate_cmd cmd = {
+        .cmd            = NUS_CMD_GATE,
+        .min_snr_db     = v[0],
+        .full_snr_db    = v[1],
+        .min_confidence = v[2],
+    };
+    shell_print(shell, "Sending confidence gate over bluetooth...");
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        shell_print(shell, "Confidence gate not sent (%d)", err);
+    }
+    return err;
+}
+
+SHELL_CMD_REGISTER(gate, NULL,
+                   "Sets the peripheral's pitch confidence gate",
+                   gate_cmd);
+
+/* Last spectrum config sent; matches the peripheral's defaults so a
+ * single `spectrum` subcommand only changes its own fields */
+static struct nus_spectrum_cmd spectrum = {
+    .cmd      = NUS_CMD_SPECTRUM,
+    .mode     = NUS_SPEC_EWMA,
+    .frames   = 4,
+    .alpha    = 0.5f,
+    .over_sub = 2.0f,
+    .floor    = 0.05f,
+};
+
+static int spectrum_send(const struct shell *shell)
+{
+    int err = command_send(&spectrum, sizeof(spectrum));
+    if (err) {
+        shell_print(shell, "Spectrum config not sent (%d)", err);
+        return err;
+    }
+    shell_print(shell, "Sent spectrum mode %u, %u frames, alpha %.2f, "
+                "over_sub %.1f, floor %.2f", spectrum.mode, spectrum.frames,
+                (double)spectrum.alpha, (double)spectrum.over_sub,
+                (double)spectrum.floor);
     return 0;
 }
 
-SHELL_CMD_REGISTER(tune, NULL, "Sets what needs to be tuned", tune_cmd);
+static int cmd_spectrum_avg(const struct shell *shell, size_t argc, char **argv)
+{
+    char *end = "";
+
+    if (argc == 2 && strcmp(argv[1], "off") == 0) {
+        spectrum.mode = NUS_SPEC_OFF;
+    } else if (argc == 3 && strcmp(argv[1], "ewma") == 0) {
+        float alpha = strtof(argv[2], &end);
+        if (*end != '\0' || alpha <= 0.0f || alpha > 1.0f) {
+            shell_print(shell, "alpha must be in (0, 1]: %s", argv[2]);
+            return -EINVAL;
+        }
+        spectrum.mode  = NUS_SPEC_EWMA;
+        spectrum.alpha = alpha;
+    } else if (argc == 3 && strcmp(argv[1], "welch") == 0) {
+        unsigned long frames = strtoul(argv[2], &end, 10);
+        if (*end != '\0' || frames < 1 || frames > 8) {
+            shell_print(shell, "Welch length must be 1..8: %s", argv[2]);
+            return -EINVAL;
+        }
+        spectrum.mode   = NUS_SPEC_WELCH;
+        spectrum.frames = frames;
+    } else {
+        shell_print(shell, "Usage: spectrum avg <off|ewma <alpha>|welch <frames>>");
+        return -EINVAL;
+    }
+    return spectrum_send(shell);
+}
+
+static int cmd_spectrum_sub(const struct shell *shell, size_t argc, char **argv)
+{
+    char *end;
+    float over_sub = strtof(argv[1], &end);
+    if (*end != '\0' || over_sub < 0.0f) {
+        shell_print(shell, "Bad over-subtraction: %s", argv[1]);
+        return -EINVAL;
+    }
+    float floor = strtof(argv[2], &end);
+    if (*end != '\0' || floor < 0.0f || floor > 1.0f) {
+        shell_print(shell, "Floor must be 0..1: %s", argv[2]);
+        return -EINVAL;
+    }
+    spectrum.over_sub = over_sub;
+    spectrum.floor    = floor;
+    return spectrum_send(shell);
+}
+
+static int cmd_spectrum_noise(const struct shell *shell, size_t argc, char **argv)
+{
+    struct nus_noise_cmd cmd = { .cmd = NUS_CMD_NOISE, .frames = 16 };
+
+    if (argc == 2) {
+        char *end;
+        unsigned long frames = strtoul(argv[1], &end, 10);
+        if (*end != '\0' || frames < 1 || frames > UINT8_MAX) {
+            shell_print(shell, "Frames must be 1..255: %s", argv[1]);
+            return -EINVAL;
+        }
+        cmd.frames = frames;
+    }
+
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        shell_print(shell, "Noise capture not sent (%d)", err);
+        return err;
+    }
+    shell_print(shell, "Learning noise over %u frames, keep the strings quiet",
+                cmd.frames);
+    return 0;
+}
+
+static int cmd_spectrum_clear(const struct shell *shell, size_t argc, char **argv)
+{
+    struct nus_noise_cmd cmd = { .cmd = NUS_CMD_NOISE, .frames = 0 };
+
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        shell_print(shell, "Noise clear not sent (%d)", err);
+    }
+    return err;
+}
+
+static bool parse_ul(const char *arg, unsigned long max, unsigned long *out)
+{
+    char *end;
+    unsigned long v = strtoul(arg, &end, 10);
+    if (end == arg || *end != '\0' || v > max) {
+        return false;
+    }
+    *out = v;
+    return true;
+}
+
+static int cmd_spectrum_stream(const struct shell *shell, size_t argc, char **argv)
+{
+    unsigned long bits = 0, every = 1, first_bin = 0, n_bins = 0;
+
+    if (argc == 4 ||
+        (strcmp(argv[1], "off") != 0 &&
+         (!parse_ul(argv[1], 8, &bits) || (bits != 4 && bits != 8)))) {
+        shell_print(shell, "Usage: spectrum stream <off|4|8> [every] "
+                    "[first_bin n_bins]");
+        return -EINVAL;
+    }
+    if (argc >= 3 && (!parse_ul(argv[2], UINT8_MAX, &every) || every == 0)) {
+        shell_print(shell, "every must be 1..%u: %s", UINT8_MAX, argv[2]);
+        return -EINVAL;
+    }
+    if (argc == 5 && (!parse_ul(argv[3], UINT16_MAX, &first_bin) ||
+                      !parse_ul(argv[4], NUS_SPEC_MAX_BINS, &n_bins))) {
+        shell_print(shell, "first_bin <= %u, n_bins <= %u (0 = tuning span)",
+                    UINT16_MAX, NUS_SPEC_MAX_BINS);
+        return -EINVAL;
+    }
+
+    struct nus_spec_stream_cmd cmd = {
+        .cmd       = NUS_CMD_SPEC_STREAM,
+        .bits      = (uint8_t)bits,
+        .every     = (uint8_t)every,
+        .first_bin = (uint16_t)first_bin,
+        .n_bins    = (uint8_t)n_bins,
+    };
+
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        shell_print(shell, "Stream request not sent (%d)", err);
+    }
+    return err;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(spectrum_cmds,
+    SHELL_CMD_ARG(avg,   NULL, "off | ewma <alpha> | welch <frames>",
+                  cmd_spectrum_avg, 2, 1),
+    SHELL_CMD_ARG(sub,   NULL, "<over_sub> <floor>, e.g. sub 2 0.05",
+                  cmd_spectrum_sub, 3, 0),
+    SHELL_CMD_ARG(noise, NULL, "[frames] learn the noise profile (default 16)",
+                  cmd_spectrum_noise, 1, 1),
+    SHELL_CMD(clear,     NULL, "Forget the noise profile", cmd_spectrum_clear),
+    SHELL_CMD_ARG(stream, NULL,
+                  "<off|4|8> [every] [first_bin n_bins] stream spectra "
+                  "for scripts/spectrum_view.py", cmd_spectrum_stream, 2, 3),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(spectrum, &spectrum_cmds,
+                   "Spectral averaging and noise subtraction on the peripheral",
+                   NULL);
+
+static int cmd_audio_start(const struct shell *shell, size_t argc, char **argv)
+{
+    struct nus_audio_cmd cmd = {
+        .cmd        = NUS_CMD_AUDIO,
+        .on         = 1,
+        .decimation = 2,
+    };
+    uint32_t rate = 8000;
+
+    if (argc == 2) {
+        rate = strtoul(argv[1], NULL, 10);
+        if (rate != 8000 && rate != 16000) {
+            shell_print(shell, "Usage: audio start [8000|16000]");
+            return -EINVAL;
+        }
+        cmd.decimation = 16000 / rate;
+    }
+    if (rate > audio_relay_max_rate()) {
+        shell_print(shell, "%u Hz is more than the console can carry "
+                    "(up to %u Hz)", rate, audio_relay_max_rate());
+        return -ENOSPC;
+    }
+
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        shell_print(shell, "Audio request not sent (%d)", err);
+        return err;
+    }
+    audio_relay_start(rate);
+    return 0;
+}
+
+static int cmd_audio_stop(const struct shell *shell, size_t argc, char **argv)
+{
+    struct nus_audio_cmd cmd = { .cmd = NUS_CMD_AUDIO };
+
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        shell_print(shell, "Audio request not sent (%d)", err);
+    }
+    return err;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(audio_cmds,
+    SHELL_CMD_ARG(start, NULL,
+                  "[8000|16000] stream raw ADPCM audio for "
+                  "scripts/audio_capture.py (default 8000)",
+                  cmd_audio_start, 1, 1),
+    SHELL_CMD(stop,      NULL, "Stop the audio stream", cmd_audio_stop),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(audio, &audio_cmds, "Raw audio capture from the peripheral",
+                   NULL);
+
+static int resolution_cmd(const struct shell *shell, size_t argc, char **argv)
+{
+    struct nus_resolution_cmd cmd = {
+        .cmd     = NUS_CMD_RESOLUTION,
+        .periods = 16,
+    };
+
+    if (argc == 2 && strcmp(argv[1], "fixed") == 0) {
+        cmd.mode = NUS_RES_FIXED;
+    } else if (strcmp(argv[1], "multi") == 0) {
+        cmd.mode = NUS_RES_MULTI;
+        if (argc == 3) {
+            char *end;
+            unsigned long periods = strtoul(argv[2], &end, 10);
+            if (*end != '\0' || periods < 4 || periods > 32) {
+                shell_print(shell, "Periods must be 4..32");
+                return -EINVAL;
+            }
+            cmd.periods = (uint8_t)periods;
+        }
+    } else {
+        shell_print(shell, "Usage:");
+        shell_print(shell, "  resolution fixed            FFT window for every string");
+        shell_print(shell, "  resolution multi [periods]  window of N string periods "
+                    "(default 16)");
+        return -EINVAL;
+    }
+
+    int err = command_send(&cmd, sizeof(cmd));
+    if (err) {
+        shell_print(shell, "Resolution not sent (%d)", err);
+    }
+    return err;
+}
+
+SHELL_CMD_ARG_REGISTER(resolution, NULL,
+                       "Per-string analysis window on the peripheral",
+                       resolution_cmd, 2, 1);
+
+#if defined(CONFIG_APP_E2E_SUMMARY)
+/* One machine-readable line per period for scripts/e2e_bsim.py, plus a
+ * read of the peripheral's counters */
+static void e2e_summary_handler(struct k_work *work)
+{
+    struct lat_summary total;
+    latency_summary(LAT_TOTAL, &total);
+
+    printk("E2E uptime_ms=%u pitch=%u lost=%u old=%u msgq_full=%u "
+           "lat_n=%u lat_avg_us=%u lat_max_us=%u\n",
+           k_uptime_get_32(), loss_stats_get(CTR_PITCH_RX),
+           loss_stats_get(CTR_SEQ_LOST), loss_stats_get(CTR_SEQ_OLD),
+           loss_stats_get(CTR_MSGQ_FULL),
+           total.count, total.avg_us, total.max_us);
+    read_peer_stats();
+
+    k_work_reschedule(k_work_delayable_from_work(work),
+                      K_MSEC(CONFIG_APP_E2E_SUMMARY_PERIOD_MS));
+}
+
+static K_WORK_DELAYABLE_DEFINE(e2e_summary_work, e2e_summary_handler);
+#endif
 
 int main(void)
 {
     bt_msg_t rx;                       /* message popped from k_msgq      */
-    float     freq     = 0.0f;         /* numeric field                   */
-    char      note[3]  = "";           /* two-char string + NUL           */
 
     printk("Main starting, launching BT thread\n");
     bluetooth_thread_start();
+    latency_init();
+    base_node_init();
+#if defined(CONFIG_APP_E2E_SUMMARY)
+    k_work_reschedule(&e2e_summary_work,
+                      K_MSEC(CONFIG_APP_E2E_SUMMARY_PERIOD_MS));
+#endif
 
     while (1) {
         if (k_msgq_get(&bt_msgq, &rx, K_FOREVER) == 0) {
-            char *ptr   = (char *)rx.data;
-            char *endp;
-            freq = strtof(ptr, &endp);                  /* converts “440.00”   */
-                                                       /* returns ptr to space */
-
-            while (isspace((unsigned char)*endp)) { ++endp; }
-
-            size_t i = 0;
-            while (i < 2 && *endp && !isspace((unsigned char)*endp)) {
-                note[i++] = *endp++;
-            }
-            note[i] = '\0';
-            if (i == 0) {
-                printk("Malformed frame: '%.*s'\n", rx.len, rx.data);
-                continue;
-            }
-            float filt = kalman_update(freq);
-            printk("%.2f %s\n", filt, note);
+            subscription_backpressure(k_msgq_num_used_get(&bt_msgq));
+            base_node_handle(&rx, nus_timestamp_us());
         }
     }
     return 0;
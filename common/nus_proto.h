@@ -0,0 +1,396 @@
+/* common/nus_proto.h
+ *
+ * Wire format shared by the Thingy:52 peripheral (dsp/) and the base
+ * node (ble_central/). Everything travels over the Nordic UART Service:
+ * commands are written to RX (central -> peripheral), results come back
+ * as TX notifications (peripheral -> central).
+ *
+ * Both ends are little-endian Cortex-M parts, so structs go on the air
+ * as-is. Every TX frame fits the 20-byte payload of the default ATT MTU.
+ */
+#ifndef NUS_PROTO_H
+#define NUS_PROTO_H
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/toolchain.h>
+
+/* Largest notification payload with the default 23-byte ATT MTU */
+#define NUS_MAX_PAYLOAD 20
+
+/* ────────────────────────────────────────────────────────────────
+ *  TX frame types (first byte of every notification)
+ *  Kept outside printable ASCII so they never clash with the old
+ *  "440.00 A2" text frames.
+ * ────────────────────────────────────────────────────────────── */
+#define NUS_FRAME_PITCH 0xA1
+#define NUS_FRAME_PONG  0xA2
+#define NUS_FRAME_PITCH_LITE 0xA3
+#define NUS_FRAME_SPECTRUM   0xA4
+#define NUS_FRAME_AUDIO      0xA5
+#define NUS_FRAME_ACK        0xA6
+#define NUS_FRAME_LOG        0xA7
+
+/* ────────────────────────────────────────────────────────────────
+ *  RX commands (first byte of every command struct)
+ * ────────────────────────────────────────────────────────────── */
+#define NUS_CMD_PING       'p'   /* struct nus_ping_cmd, sent bare */
+#define NUS_CMD_MODE       'm'   /* struct nus_mode_cmd */
+#define NUS_CMD_REPORT_CFG 'c'   /* struct nus_report_cfg_cmd */
+#define NUS_CMD_PROFILE    'T'   /* struct nus_profile_cmd */
+#define NUS_CMD_GATE       'g'   /* struct nus_gate_cmd */
+#define NUS_CMD_SUBSCRIBE  'S'   /* struct nus_subscribe_cmd */
+#define NUS_CMD_LINK       'L'   /* struct nus_link_cmd */
+#define NUS_CMD_SPECTRUM   'a'   /* struct nus_spectrum_cmd */
+#define NUS_CMD_NOISE      'n'   /* struct nus_noise_cmd */
+#define NUS_CMD_SPEC_STREAM 'V'  /* struct nus_spec_stream_cmd */
+#define NUS_CMD_AUDIO      'A'   /* struct nus_audio_cmd */
+#define NUS_CMD_RESOLUTION 'R'   /* struct nus_resolution_cmd */
+#define NUS_CMD_LOG        'l'   /* struct nus_log_cmd */
+#define NUS_CMD_LOG_CREDIT 'k'   /* struct nus_log_credit_cmd */
+
+#define NUS_NOTE_LEN 3
+
+/* Requests. Every command but the clock probe travels wrapped: a
+ * nus_req_hdr, then the command struct, all in one write-without-
+ * response. The peripheral answers each request with a nus_ack_frame
+ * on TX. req_id is picked by the central; the peripheral remembers the
+ * last few it handled so a retry after a lost ack is acknowledged
+ * again rather than applied twice. */
+#define NUS_REQ       0xC0
+
+struct nus_req_hdr {
+    uint8_t  type;                 /* NUS_REQ */
+    uint8_t  req_id;
+} __packed;
+
+#define NUS_REQ_MAX_CMD (NUS_MAX_PAYLOAD - sizeof(struct nus_req_hdr))
+
+struct nus_ack_frame {
+    uint8_t  type;                 /* NUS_FRAME_ACK */
+    uint8_t  req_id;
+    uint8_t  cmd;                  /* opcode acknowledged */
+    int8_t   status;               /* 0 or -errno */
+} __packed;
+
+/* Tuner mode: read any pitch, or tune towards one note */
+#define NUS_MODE_READ 0
+#define NUS_MODE_TUNE 1
+
+struct nus_mode_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_MODE */
+    uint8_t  mode;                 /* NUS_MODE_* */
+    char     note[NUS_NOTE_LEN];   /* MODE_TUNE target, NUL padded */
+} __packed;
+
+/* Report policy (dsp/lib/report_policy) */
+struct nus_report_cfg_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_REPORT_CFG */
+    float    hyst_cents;
+    uint32_t min_interval_ms;
+    uint32_t heartbeat_ms;
+} __packed;
+
+/* Confidence gate (dsp/lib/peak_picker) */
+struct nus_gate_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_GATE */
+    float    min_snr_db;
+    float    full_snr_db;
+    float    min_confidence;
+} __packed;
+
+/* One pitch result. The timestamps are on the peripheral clock and
+ * split the peripheral side into capture and DSP stages; the DSP stage
+ * is always well under a block (~50 ms), so it travels as a 16-bit
+ * duration to leave room for the sequence number. */
+struct nus_pitch_frame {
+    uint8_t  type;                 /* NUS_FRAME_PITCH */
+    char     note[NUS_NOTE_LEN];   /* "E2", NUL padded, not terminated */
+    float    freq_hz;
+    uint16_t seq;                  /* +1 per frame offered to the link */
+    uint16_t dsp_us;               /* block claimed from pcm_ring -> result */
+    uint32_t t_capture_us;         /* dmic_read() handed over the block */
+    uint32_t t_dsp_end_us;         /* result ready, handed to BLE */
+} __packed;
+
+/* Pitch result without stage timestamps (NUS_DETAIL_BASIC). Shares the
+ * sequence space with nus_pitch_frame. */
+struct nus_pitch_lite_frame {
+    uint8_t  type;                 /* NUS_FRAME_PITCH_LITE */
+    char     note[NUS_NOTE_LEN];
+    float    freq_hz;
+    uint16_t seq;
+    uint8_t  confidence;           /* peak confidence, 0..255 */
+    int8_t   snr_db;
+} __packed;
+
+/* Clock-offset probe: central stamps, peripheral echoes with its own */
+struct nus_ping_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_PING */
+    uint32_t t_central_us;
+} __packed;
+
+struct nus_pong_frame {
+    uint8_t  type;                 /* NUS_FRAME_PONG */
+    uint8_t  rsvd[3];
+    uint32_t t_central_us;         /* echoed from the ping */
+    uint32_t t_periph_us;          /* peripheral clock at ping arrival */
+} __packed;
+
+/* Tuning profile push: strings as MIDI note numbers, lowest first by
+ * convention (the peripheral does not depend on the order) */
+#define NUS_PROFILE_MAX_STRINGS 8
+
+struct nus_profile_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_PROFILE */
+    float    a4_hz;                /* reference pitch, 400..480 */
+    uint8_t  count;
+    uint8_t  midi[NUS_PROFILE_MAX_STRINGS];
+} __packed;
+
+/* Peripheral loss counters, exposed as a read-only characteristic in
+ * the NUS service: NUS_PERIPH_CTR_COUNT little-endian uint32_t in list
+ * order. Both ends build their names from this list. */
+#define NUS_STATS_CHAR_UUID_VAL \
+    BT_UUID_128_ENCODE(0x6e40a001, 0xb5a3, 0xf393, 0xe0a9, 0xe50e24dcca9e)
+
+#define NUS_PERIPH_COUNTERS(X)                                          \
+    X(CTR_BLOCKS_CAPTURED,  "blocks captured")                          \
+    X(CTR_DMIC_ERRORS,      "dmic_read errors")                         \
+    X(CTR_RING_DROPPED,     "blocks dropped, pcm_ring full")            \
+    X(CTR_RING_SHORT,       "blocks truncated into pcm_ring")           \
+    X(CTR_TS_QUEUE_FULL,    "capture stamps dropped")                   \
+    X(CTR_BLOCKS_PROCESSED, "blocks processed")                         \
+    X(CTR_BLOCK_GAPS,       "capture gaps seen by DSP")                 \
+    X(CTR_FRAMES_GATED,     "frames below confidence gate")             \
+    X(CTR_FRAMES_HELD,      "frames held by report policy")             \
+    X(CTR_FRAMES_OFFERED,   "frames offered to BLE")                    \
+    X(CTR_NOTIFY_NOT_READY, "frames not sent, no subscriber")           \
+    X(CTR_NOTIFY_ERRORS,    "frames lost, bt_gatt_notify error")        \
+    X(CTR_AUDIO_SENT,       "audio packets sent")                       \
+    X(CTR_AUDIO_DROPPED,    "audio packets dropped, queue full/error")  \
+    X(CTR_AUDIO_SKIPPED,    "audio packets skipped over capture gaps")  \
+    X(CTR_RESULTS_DROPPED,  "results a consumer had no room for")       \
+    X(CTR_RESULTS_UNLOGGED, "results skipped by the log consumer")     \
+    X(CTR_LOG_STORED,       "results stored in the flash log")         \
+    X(CTR_LOG_LOST,         "results not stored, queue full/flash")    \
+    X(CTR_LOG_OVERWRITTEN,  "log sectors overwritten, log full")       \
+    X(CTR_LOG_UPLOADED,     "log records uploaded")                   \
+    X(CTR_LOG_THINNED,      "results not stored, offline thinning")
+
+#define NUS_CTR_ID(id, name) id,
+enum nus_periph_ctr {
+    NUS_PERIPH_COUNTERS(NUS_CTR_ID)
+    NUS_PERIPH_CTR_COUNT
+};
+#undef NUS_CTR_ID
+
+/* Subscription: what the central wants to receive. The peripheral
+ * adapts analysis stride and report cadence to rate_dhz, and picks the
+ * frame type from detail. Defaults apply again on every connect. */
+#define NUS_DETAIL_BASIC 0         /* nus_pitch_lite_frame */
+#define NUS_DETAIL_TRACE 1         /* nus_pitch_frame, with timestamps */
+
+#define NUS_RATE_DEFAULT_DHZ 100   /* 10 frames/s, one per DMIC block */
+#define NUS_RATE_MIN_DHZ     1
+#define NUS_RATE_MAX_DHZ     200
+
+struct nus_subscribe_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_SUBSCRIBE */
+    uint16_t rate_dhz;             /* target frames/s x 10 */
+    uint8_t  detail;               /* NUS_DETAIL_* */
+} __packed;
+
+/* Link profiles: connection interval, peripheral latency, supervision
+ * timeout and PHY, negotiated by the peripheral (dsp/lib/link_profile).
+ * In auto the peripheral picks FAST in MODE_TUNE, BALANCED otherwise. */
+enum nus_link_profile {
+    NUS_LINK_FAST,                 /* 7.5-15 ms, 2M: live tuning needle */
+    NUS_LINK_BALANCED,             /* 30-50 ms, 1M: note readout */
+    NUS_LINK_LOWPOWER,             /* 100-200 ms, latency 4, 1M: idle */
+    NUS_LINK_RANGE,                /* 50-100 ms, Coded S8: far from base */
+    NUS_LINK_PROFILE_COUNT,
+    NUS_LINK_AUTO = 0xFF,
+};
+
+struct nus_link_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_LINK */
+    uint8_t  profile;              /* enum nus_link_profile */
+} __packed;
+
+/* Spectral averaging ahead of the peak search (dsp/lib/spectral_avg) */
+#define NUS_SPEC_OFF   0
+#define NUS_SPEC_EWMA  1
+#define NUS_SPEC_WELCH 2
+
+struct nus_spectrum_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_SPECTRUM */
+    uint8_t  mode;                 /* NUS_SPEC_* */
+    uint8_t  frames;               /* Welch length */
+    float    alpha;                /* EWMA weight of the newest frame */
+    float    over_sub;             /* noise profile multiplier, 0 = off */
+    float    floor;                /* min fraction of a bin's power kept */
+} __packed;
+
+/* Learn the noise profile over the next frames (strings muted), or
+ * forget it with frames = 0 */
+struct nus_noise_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_NOISE */
+    uint8_t  frames;
+} __packed;
+
+/* Spectrum streaming for host-side plots (dsp/lib/spectrum_stream).
+ *
+ * One spectrum is a header plus one quantised log magnitude per bin:
+ * q * step_ddb / 10 dB above 0 dB (|X| = 1). Key frames carry q as
+ * bytes; the others carry the change since the previous spectrum,
+ * int8 per bin or a signed nibble per bin (low nibble first) with
+ * NUS_SPEC_NIBBLES. The encoder tracks what the decoder rebuilds, so
+ * clamped steps catch up over the next frames instead of drifting.
+ * A key frame follows every NUS_SPEC_KEY_INTERVAL frames, any change
+ * of band or resolution, and (re)connects; after a lost chunk the
+ * receiver waits for it.
+ *
+ * The spectrum is cut into notifications of at most NUS_MAX_PAYLOAD,
+ * each led by a nus_spec_chunk_hdr. */
+#define NUS_SPEC_MAX_BINS     128
+#define NUS_SPEC_MAX_CHUNKS   16
+#define NUS_SPEC_KEY_INTERVAL 16
+
+#define NUS_SPEC_KEY     BIT(0)
+#define NUS_SPEC_NIBBLES BIT(1)
+
+struct nus_spec_chunk_hdr {
+    uint8_t  type;                 /* NUS_FRAME_SPECTRUM */
+    uint8_t  seq;                  /* spectrum counter, same in every chunk */
+    uint8_t  part;                 /* chunk index << 4 | (chunks - 1) */
+    uint8_t  flags;                /* NUS_SPEC_* */
+} __packed;
+
+struct nus_spec_hdr {
+    uint16_t first_bin;
+    uint8_t  n_bins;
+    uint8_t  step_ddb;             /* quantiser step, 0.1 dB units */
+} __packed;
+
+#define NUS_SPEC_CHUNK_DATA (NUS_MAX_PAYLOAD - sizeof(struct nus_spec_chunk_hdr))
+
+/* bits 0 stops the stream; n_bins 0 follows the tuning span */
+struct nus_spec_stream_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_SPEC_STREAM */
+    uint8_t  bits;                 /* 0, 4 or 8 per bin in delta frames */
+    uint8_t  every;                /* one spectrum per this many frames */
+    uint16_t first_bin;
+    uint8_t  n_bins;
+} __packed;
+
+BUILD_ASSERT(sizeof(struct nus_spec_hdr) + NUS_SPEC_MAX_BINS <=
+             NUS_SPEC_MAX_CHUNKS * NUS_SPEC_CHUNK_DATA,
+             "a key frame must fit the chunk count");
+/* Raw audio capture (dsp/lib/audio_capture): the microphone stream,
+ * optionally halved to 8 kHz, as IMA-ADPCM. Every packet carries the
+ * decoder state it starts from, so a lost packet costs only its own
+ * NUS_AUDIO_SAMPLES samples. seq counts packets including those that
+ * were dropped or fell in a capture gap, so (seq gap) x samples is the
+ * silence to insert. Nibbles are low first, as in IMA WAV. */
+#define NUS_AUDIO_BYTES   14
+#define NUS_AUDIO_SAMPLES (2 * NUS_AUDIO_BYTES)
+
+struct nus_audio_frame {
+    uint8_t  type;                 /* NUS_FRAME_AUDIO */
+    uint16_t seq;
+    int16_t  predictor;            /* decoder state before sample 0 */
+    uint8_t  step_index;           /* 0..88 */
+    uint8_t  data[NUS_AUDIO_BYTES];
+} __packed;
+
+struct nus_audio_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_AUDIO */
+    uint8_t  on;
+    uint8_t  decimation;           /* 1 = 16 kHz, 2 = 8 kHz */
+} __packed;
+
+/* Time-frequency resolution (dsp/lib/multires): FIXED (the default)
+ * reports the FFT estimate, MULTI re-measures the detected or targeted
+ * string over periods cycles of its own pitch */
+#define NUS_RES_FIXED 0
+#define NUS_RES_MULTI 1
+
+struct nus_resolution_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_RESOLUTION */
+    uint8_t  mode;                 /* NUS_RES_* */
+    uint8_t  periods;              /* 4..32, MULTI only */
+} __packed;
+
+/* Store-and-forward pitch log (dsp/lib/pitch_log). Results the
+ * peripheral could not deliver, and every reported result while
+ * recording is on, go to a circular log in flash. NUS_LOG_OP_UPLOAD
+ * streams it back oldest first as NUS_FRAME_LOG chunks, each as large
+ * as the ATT MTU allows. The last chunk has NUS_LOG_LAST set and may
+ * hold no records. Chunks go out only up to the credit the central
+ * has granted: the upload's arg, then each nus_log_credit_cmd. Limits
+ * are absolute chunk numbers, so a newer grant can replace an older
+ * one. NUS_LOG_OP_COMMIT frees what the last upload sent. A central
+ * sends it only after getting every chunk. */
+#define NUS_LOG_CHUNK_MAX 244          /* 251-byte LL payload less L2CAP/ATT */
+
+#define NUS_LOG_LAST BIT(0)
+
+struct nus_log_chunk_hdr {
+    uint8_t  type;                 /* NUS_FRAME_LOG */
+    uint8_t  flags;                /* NUS_LOG_* */
+    uint16_t seq;                  /* chunk number within the upload */
+} __packed;
+
+struct nus_log_record {
+    uint16_t boot;                 /* peripheral boot count */
+    uint32_t t_ms;                 /* uptime at the result, since that boot */
+    float    freq_hz;
+    char     note[NUS_NOTE_LEN];
+    uint8_t  confidence;           /* 0..255 */
+} __packed;
+
+#define NUS_LOG_OP_RECORD 0            /* arg 1: log every reported result */
+#define NUS_LOG_OP_UPLOAD 1            /* arg: chunks below this may go */
+#define NUS_LOG_OP_COMMIT 2
+#define NUS_LOG_OP_ERASE  3
+
+struct nus_log_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_LOG */
+    uint8_t  op;                   /* NUS_LOG_OP_* */
+    uint16_t arg;
+} __packed;
+
+struct nus_log_credit_cmd {
+    uint8_t  cmd;                  /* NUS_CMD_LOG_CREDIT */
+    uint16_t limit;                /* chunks below this may go */
+} __packed;
+
+BUILD_ASSERT(sizeof(struct nus_log_chunk_hdr) + sizeof(struct nus_log_record)
+             <= NUS_MAX_PAYLOAD,
+             "a log chunk must carry a record at the default MTU");
+BUILD_ASSERT(sizeof(struct nus_audio_frame) == NUS_MAX_PAYLOAD,
+             "audio packet fills a default-MTU notification");
+BUILD_ASSERT(sizeof(struct nus_spectrum_cmd) <= NUS_REQ_MAX_CMD,
+             "spectrum config must fit a single request");
+BUILD_ASSERT(sizeof(struct nus_profile_cmd) <= NUS_REQ_MAX_CMD,
+             "profile push must fit a single request");
+BUILD_ASSERT(sizeof(struct nus_report_cfg_cmd) <= NUS_REQ_MAX_CMD,
+             "report config must fit a single request");
+BUILD_ASSERT(sizeof(struct nus_gate_cmd) <= NUS_REQ_MAX_CMD,
+             "gate config must fit a single request");
+BUILD_ASSERT(sizeof(struct nus_pitch_frame) <= NUS_MAX_PAYLOAD,
+             "pitch frame must fit a default-MTU notification");
+BUILD_ASSERT(sizeof(struct nus_pitch_lite_frame) <= NUS_MAX_PAYLOAD,
+             "lite frame must fit a default-MTU notification");
+BUILD_ASSERT(sizeof(struct nus_pong_frame) <= NUS_MAX_PAYLOAD,
+             "pong frame must fit a default-MTU notification");
+
+/* Free-running microsecond stamp used on both nodes. Wraps every ~71
+ * minutes; only differences are ever used, so unsigned maths is fine. */
+static inline uint32_t nus_timestamp_us(void)
+{
+    return (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+#endif /* NUS_PROTO_H */
@@ -0,0 +1,225 @@
+#include "audio_capture.h"
+#include "bluetooth.h"
+#include "link_profile.h"
+#include "loss_stats.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+/* ~220 ms of 8 kHz audio between the DSP thread and the link */
+#define AUDIO_QUEUE_DEPTH 64
+#define AUDIO_TX_STACK    1024
+#define AUDIO_TX_PRIORITY 8         /* below the DSP thread */
+
+/* Half-band low-pass ahead of the 2:1 decimator, taps sum to 32 */
+#define HB_TAPS 7
+static const int8_t halfband[HB_TAPS] = { -1, 0, 9, 16, 9, 0, -1 };
+
+static const int16_t step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37,
+    41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173,
+    190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+    724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484,
+    7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818,
+    18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+static const int8_t index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+K_MSGQ_DEFINE(audio_q, sizeof(struct nus_audio_frame), AUDIO_QUEUE_DEPTH, 4);
+
+static bool    active;
+static bool    restart;
+static uint8_t decimation = 2;
+
+/* active/restart/decimation are written from the BT RX thread, read
+ * from the DSP thread */
+static struct k_spinlock lock;
+
+/* Encoder state, DSP thread only */
+static int32_t  hist[HB_TAPS];
+static uint8_t  phase;
+static int16_t  predictor;
+static uint8_t  step_index;
+static struct nus_audio_frame pkt;
+static uint8_t  pkt_samples;
+static uint16_t seq;
+static uint32_t last_capture_us;
+static bool     have_last;
+
+int audio_capture_set(const struct nus_audio_cmd *cmd)
+{
+    if (cmd->on && cmd->decimation != 1 && cmd->decimation != 2) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    active  = cmd->on;
+    restart = true;
+    if (cmd->on) {
+        decimation = cmd->decimation;
+    }
+    k_spin_unlock(&lock, key);
+
+    /* Audio needs the fast link even outside MODE_TUNE */
+    link_profile_audio(cmd->on);
+    return 0;
+}
+
+void audio_capture_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    active  = false;
+    restart = true;
+    k_spin_unlock(&lock, key);
+    k_msgq_purge(&audio_q);
+}
+
+bool audio_capture_active(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool on = active;
+    k_spin_unlock(&lock, key);
+    return on;
+}
+
+static uint8_t ima_encode(int32_t sample)
+{
+    int32_t diff = sample - predictor;
+    int32_t step = step_table[step_index];
+    int32_t vpdiff = step >> 3;
+    uint8_t nib = 0;
+
+    if (diff < 0) {
+        nib  = 8;
+        diff = -diff;
+    }
+    if (diff >= step) {
+        nib |= 4;
+        diff -= step;
+        vpdiff += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nib |= 2;
+        diff -= step;
+        vpdiff += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nib |= 1;
+        vpdiff += step;
+    }
+
+    int32_t p = predictor + ((nib & 8) ? -vpdiff : vpdiff);
+    predictor  = (int16_t)CLAMP(p, INT16_MIN, INT16_MAX);
+    step_index = (uint8_t)CLAMP(step_index + index_table[nib], 0, 88);
+    return nib;
+}
+
+static void packet_done(void)
+{
+    if (k_msgq_put(&audio_q, &pkt, K_NO_WAIT) != 0) {
+        loss_stats_inc(CTR_AUDIO_DROPPED);
+    }
+    pkt_samples = 0;
+    seq++;
+}
+
+static void push_sample(int32_t sample)
+{
+    if (pkt_samples == 0) {
+        memset(&pkt, 0, sizeof(pkt));
+        pkt.type       = NUS_FRAME_AUDIO;
+        pkt.seq        = seq;
+        pkt.predictor  = predictor;
+        pkt.step_index = step_index;
+    }
+
+    uint8_t nib = ima_encode(sample);
+    pkt.data[pkt_samples / 2] |= nib << ((pkt_samples & 1) * 4);
+    if (++pkt_samples == NUS_AUDIO_SAMPLES) {
+        packet_done();
+    }
+}
+
+void audio_capture_block(const int16_t *pcm, size_t n, uint32_t rate_hz,
+                         uint32_t t_capture_us)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool    on    = active;
+    bool    fresh = restart;
+    uint8_t dec   = decimation;
+    restart = false;
+    k_spin_unlock(&lock, key);
+
+    if (!on) {
+        return;
+    }
+    if (fresh) {
+        memset(hist, 0, sizeof(hist));
+        phase       = 0;
+        predictor   = 0;
+        step_index  = 0;
+        pkt_samples = 0;
+        seq         = 0;
+        have_last   = false;
+        printk("DSP: audio capture at %u Hz\n", rate_hz / dec);
+    }
+
+    /* Blocks lost before the DSP thread: skip the packets they would
+     * have filled so the host keeps time */
+    uint32_t block_us = (uint32_t)(n * 1000000ULL / rate_hz);
+    uint32_t gap_us   = t_capture_us - last_capture_us;
+    if (have_last && gap_us > block_us + block_us / 2) {
+        uint32_t lost = (uint32_t)((uint64_t)(gap_us - block_us) *
+                                   rate_hz / dec / 1000000U);
+        uint32_t skip = DIV_ROUND_UP(pkt_samples + lost, NUS_AUDIO_SAMPLES);
+        seq += skip;
+        pkt_samples = 0;
+        for (uint32_t i = 0; i < skip; i++) {
+            loss_stats_inc(CTR_AUDIO_SKIPPED);
+        }
+    }
+    last_capture_us = t_capture_us;
+    have_last       = true;
+
+    for (size_t i = 0; i < n; i++) {
+        if (dec == 1) {
+            push_sample(pcm[i]);
+            continue;
+        }
+        memmove(&hist[0], &hist[1], (HB_TAPS - 1) * sizeof(hist[0]));
+        hist[HB_TAPS - 1] = pcm[i];
+        phase ^= 1;
+        if (phase) {
+            continue;
+        }
+        int32_t acc = 0;
+        for (int t = 0; t < HB_TAPS; t++) {
+            acc += halfband[t] * hist[t];
+        }
+        push_sample(CLAMP(acc / 32, INT16_MIN, INT16_MAX));
+    }
+}
+
+static void audio_tx_entry(void *p1, void *p2, void *p3)
+{
+    struct nus_audio_frame out;
+
+    while (1) {
+        k_msgq_get(&audio_q, &out, K_FOREVER);
+        if (nus_send(&out, sizeof(out)) == 0) {
+            loss_stats_inc(CTR_AUDIO_SENT);
+        } else {
+            loss_stats_inc(CTR_AUDIO_DROPPED);
+        }
+    }
+}
+
+K_THREAD_DEFINE(audio_tx, AUDIO_TX_STACK, audio_tx_entry, NULL, NULL, NULL,
+                AUDIO_TX_PRIORITY, 0, 0);
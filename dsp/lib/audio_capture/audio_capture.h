@@ -0,0 +1,31 @@
+#ifndef AUDIO_CAPTURE_H
+#define AUDIO_CAPTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "nus_proto.h"
+
+/* Raw microphone capture over BLE for recording datasets.
+ *
+ * While on, every block the DSP thread claims from pcm_ring is also
+ * low-passed and decimated (16 kHz -> 8 kHz by default), IMA-ADPCM
+ * encoded 4:1 and queued as NUS_FRAME_AUDIO packets. A sender thread
+ * drains the queue into notifications, so a slow link drops packets
+ * (counted, and visible to the host as sequence gaps) instead of
+ * stalling pitch detection. Capture gaps upstream advance the
+ * sequence number by the samples lost.
+ *
+ * Only the DSP thread may call audio_capture_block().
+ */
+
+/* BT RX thread: start/stop; -EINVAL for a bad decimation */
+int  audio_capture_set(const struct nus_audio_cmd *cmd);
+void audio_capture_reset(void);
+bool audio_capture_active(void);
+
+/* DSP thread: one block of 16-bit mono PCM at rate_hz */
+void audio_capture_block(const int16_t *pcm, size_t n, uint32_t rate_hz,
+                         uint32_t t_capture_us);
+
+#endif /* AUDIO_CAPTURE_H */
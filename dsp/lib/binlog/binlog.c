@@ -0,0 +1,12 @@
+#include "binlog.h"
+
+uint16_t binlog_seq;
+
+static uint8_t rtt_buf[CONFIG_APP_BINLOG_RTT_BUFFER_SIZE];
+
+int binlog_init(void)
+{
+    return SEGGER_RTT_ConfigUpBuffer(BINLOG_RTT_CHANNEL, "binlog",
+                                     rtt_buf, sizeof(rtt_buf),
+                                     SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+}
@@ -0,0 +1,82 @@
+#ifndef BINLOG_H
+#define BINLOG_H
+
+/* Deferred binary logging for the per-result diagnostics.
+ *
+ * Instead of formatting floats with printk on every result, the log
+ * consumer (src/consumers.c) drops a fixed 16-byte record into its own
+ * RTT up-buffer and
+ * moves on; the debug probe drains it and scripts/binlog_decode.py turns
+ * records back into text using the dictionary below. A record costs a
+ * cycle-counter read and a 16-byte copy.
+ *
+ * Single producer: only the log consumer thread may call binlog_put().
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <SEGGER_RTT.h>
+
+/* Dictionary: id, host-side format. Conversions map one-to-one onto the
+ * two 32-bit args: %f = float bits, %s = up to 4 packed chars, %d/%u =
+ * integer. binlog_decode.py parses this list straight out of the header. */
+#define BINLOG_EVENTS(X)                                      \
+    X(BL_FFT_PEAK,    "FFT peak: %.1f Hz")                    \
+    X(BL_PEAK_NOTE,   "Peak %.1f Hz and Note: %s")            \
+    X(BL_DETECTED,    "Detected note: %s")                    \
+    X(BL_LOW_CONF,    "Low confidence: %.1f Hz, SNR %.1f dB") \
+    X(BL_LOG_COST,    "Log cost: %u cycles/result")
+
+#define BINLOG_ID(id, fmt) id,
+enum binlog_id {
+    BINLOG_EVENTS(BINLOG_ID)
+    BL_COUNT
+};
+#undef BINLOG_ID
+
+#define BINLOG_MAGIC       0xB1
+#define BINLOG_RTT_CHANNEL 1
+
+struct binlog_rec {
+    uint8_t  magic;     /* BINLOG_MAGIC, lets the decoder resync */
+    uint8_t  id;        /* enum binlog_id */
+    uint16_t seq;       /* gaps = records skipped on a full buffer */
+    uint32_t cycles;    /* k_cycle_get_32() */
+    uint32_t arg[2];
+} __packed;
+
+extern uint16_t binlog_seq;
+
+/* Register the RTT up-buffer; call once before the DSP thread publishes */
+int binlog_init(void);
+
+static inline uint32_t binlog_f32(float v)
+{
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    return u;
+}
+
+static inline uint32_t binlog_str(const char *s)
+{
+    uint32_t u = 0;
+    strncpy((char *)&u, s, sizeof(u));
+    return u;
+}
+
+static inline void binlog_put(enum binlog_id id, uint32_t a0, uint32_t a1)
+{
+    struct binlog_rec rec = {
+        .magic  = BINLOG_MAGIC,
+        .id     = id,
+        .seq    = binlog_seq++,
+        .cycles = k_cycle_get_32(),
+        .arg    = { a0, a1 },
+    };
+
+    /* NO_BLOCK_SKIP mode: whole record or nothing, never stalls */
+    SEGGER_RTT_WriteNoLock(BINLOG_RTT_CHANNEL, &rec, sizeof(rec));
+}
+
+#endif /* BINLOG_H */
@@ -1,4 +1,21 @@
 #include "bluetooth.h"
+#include "nus_proto.h"
+#include "report_policy.h"
+#include "tuning.h"
+#include "peak_picker.h"
+#include "loss_stats.h"
+#include "subscription.h"
+#include "link_profile.h"
+#include "spectral_avg.h"
+#include "spectrum_stream.h"
+#include "audio_capture.h"
+#include "results_bus.h"
+#include "multires.h"
+#if defined(CONFIG_APP_PITCH_LOG)
+#include "pitch_log.h"
+#endif
+
+#include <string.h>
 
 /* 128-bit Nordic UART Service (NUS) UUIDs */
 #define BT_UUID_NUS_SERVICE_VAL   \
@@ -8,52 +25,325 @@
 #define BT_UUID_NUS_CHAR_TX_VAL   \
   BT_UUID_128_ENCODE(0x6e400003,0xb5a3,0xf393,0xe0a9,0xe50e24dcca9e)
 
-char target_note[MAX_NOTE_LEN];
-enum bt_mode current_mode = MODE_READ;
+struct bt_conn *current_conn;
+const struct bt_gatt_attr *nus_tx_attr;
+static bool tx_notify_enabled;
 
-static ssize_t on_nus_rx(struct bt_conn *conn,
-    const struct bt_gatt_attr *attr,
-    const void *buf, uint16_t len,
-    uint16_t offset, uint8_t flags){
+/* Request IDs already handled this connection, with their result, so
+ * a retried request is acknowledged again instead of applied twice */
+#define REQ_HISTORY 8
 
-    const char *in = (const char *)buf;
-    if (len == 0){
-        return len;
-    }
+static struct {
+    uint8_t req_id;
+    uint8_t cmd;
+    int8_t  status;
+} req_history[REQ_HISTORY];
+static uint8_t req_history_len;
+static uint8_t req_history_next;
 
+/* Apply one command; 0 or -errno for the ack */
+static int handle_command(const uint8_t *in, uint16_t len)
+{
     switch (in[0])
     {
-        case 'r':{
-            current_mode = MODE_READ;
-            printk("BT: Mode = READ_ANY_FREQUENCY\n");
-            break;
+        case NUS_CMD_MODE:{
+            struct nus_mode_cmd cmd;
+            if (len < sizeof(cmd)) {
+                return -EMSGSIZE;
+            }
+            memcpy(&cmd, in, sizeof(cmd));
+
+            if (cmd.mode == NUS_MODE_READ) {
+                tuner_config_set(MODE_READ, "");
+                printk("BT: Mode = READ_ANY_FREQUENCY\n");
+                link_profile_mode(MODE_READ);
+                return 0;
+            }
+
+            char note[MAX_NOTE_LEN];
+            size_t note_len = strnlen(cmd.note, NUS_NOTE_LEN);
+            memcpy(note, cmd.note, note_len);
+            note[note_len] = '\0';
+            if (cmd.mode != NUS_MODE_TUNE || note_len == 0) {
+                printk("BT: bad mode %u '%s'\n", cmd.mode, note);
+                return -EINVAL;
+            }
+            tuner_config_set(MODE_TUNE, note);
+            printk("BT: MODE_TUNE, target_note='%s'\n", note);
+            link_profile_mode(MODE_TUNE);
+            return 0;
         }
-        case 't':{
-            /* Find how many chars until space, newline, or end */
-            size_t note_len = strcspn(in + 1, " \r\n");
+        case NUS_CMD_PROFILE:{
+            struct nus_profile_cmd cmd;
+            if (len < sizeof(cmd)) {
+                return -EMSGSIZE;
+            }
+            memcpy(&cmd, in, sizeof(cmd));
 
-            /* Clamp to leave room for NUL */
-            if (note_len >= MAX_NOTE_LEN) {
-                note_len = MAX_NOTE_LEN - 1;
+            struct tuning_profile profile = {
+                .a4_hz = cmd.a4_hz,
+                .count = cmd.count,
+            };
+            memcpy(profile.midi, cmd.midi, sizeof(profile.midi));
+
+            int err = tuning_request(&profile);
+            printk("BT: profile %u strings, A4=%.1f Hz -> %d\n",
+                   cmd.count, (double)cmd.a4_hz, err);
+            return err;
+        }
+        case NUS_CMD_REPORT_CFG:{
+            struct nus_report_cfg_cmd cmd;
+            if (len < sizeof(cmd)) {
+                return -EMSGSIZE;
+            }
+            memcpy(&cmd, in, sizeof(cmd));
+            if (cmd.hyst_cents < 0.0f) {
+                return -EINVAL;
+            }
+
+            struct report_policy_cfg rcfg = {
+                .hyst_cents      = cmd.hyst_cents,
+                .min_interval_ms = cmd.min_interval_ms,
+                .heartbeat_ms    = cmd.heartbeat_ms,
+            };
+            report_policy_set(&rcfg);
+
+            struct report_policy_stats st;
+            report_policy_stats_get(&st);
+            printk("BT: report hyst=%.1f cents min=%u ms heartbeat=%u ms "
+                   "(sent %u+%u, suppressed %u hyst/%u rate)\n",
+                   (double)rcfg.hyst_cents, rcfg.min_interval_ms,
+                   rcfg.heartbeat_ms, st.sent_change, st.sent_heartbeat,
+                   st.suppressed_hyst, st.suppressed_rate);
+            return 0;
+        }
+        case NUS_CMD_GATE:{
+            struct nus_gate_cmd cmd;
+            if (len < sizeof(cmd)) {
+                return -EMSGSIZE;
             }
+            memcpy(&cmd, in, sizeof(cmd));
+            if (cmd.full_snr_db <= cmd.min_snr_db ||
+                cmd.min_confidence < 0.0f || cmd.min_confidence > 1.0f) {
+                return -EINVAL;
+            }
+
+            struct peak_picker_cfg pcfg = {
+                .min_snr_db     = cmd.min_snr_db,
+                .full_snr_db    = cmd.full_snr_db,
+                .min_confidence = cmd.min_confidence,
+            };
+            peak_picker_set(&pcfg);
 
-            /* Copy the note substring (in[1..1+note_len)) */
-            strncpy(target_note, in + 1, note_len);
-            target_note[note_len] = '\0';
+            struct peak_picker_stats st;
+            peak_picker_stats_get(&st);
+            printk("BT: gate snr %.1f..%.1f dB min conf %.2f "
+                   "(%u frames, %u suppressed)\n",
+                   (double)pcfg.min_snr_db, (double)pcfg.full_snr_db,
+                   (double)pcfg.min_confidence, st.frames, st.suppressed);
+            return 0;
+        }
+        case NUS_CMD_SUBSCRIBE:{
+            struct nus_subscribe_cmd cmd;
+            if (len < sizeof(cmd)) {
+                return -EMSGSIZE;
+            }
+            memcpy(&cmd, in, sizeof(cmd));
 
-            if (note_len > 0) {
-                current_mode = MODE_TUNE;
-                printk("BT: MODE_TUNE, target_note='%s'\n", target_note);
+            int err = subscription_set(&cmd);
+            if (err) {
+                printk("BT: bad subscribe (%u dHz, detail %u)\n",
+                       cmd.rate_dhz, cmd.detail);
+            }
+            return err;
+        }
+        case NUS_CMD_LINK:{
+            struct nus_link_cmd cmd;
+            if (len < sizeof(cmd)) {
+                return -EMSGSIZE;
+            }
+            memcpy(&cmd, in, sizeof(cmd));
+
+            int err = link_profile_request(cmd.profile);
+            if (err) {
+                printk("BT: unknown link profile %u\n", cmd.profile);
+            }
+            return err;
+        }
+        case NUS_CMD_SPECTRUM:{
+            struct nus_spectrum_cmd cmd;
+            if (len < sizeof(cmd)) {
+                return -EMSGSIZE;
+            }
+            memcpy(&cmd, in, sizeof(cmd));
+
+            struct spec_avg_cfg scfg = {
+                .mode     = cmd.mode,
+                .frames   = cmd.frames,
+                .alpha    = cmd.alpha,
+                .over_sub = cmd.over_sub,
+                .floor    = cmd.floor,
+            };
+            int err = spectral_avg_set(&scfg);
+            printk("BT: spectrum mode %u, %u frames, alpha %.2f, "
+                   "over_sub %.1f, floor %.2f -> %d\n",
+                   cmd.mode, cmd.frames, (double)cmd.alpha,
+                   (double)cmd.over_sub, (double)cmd.floor, err);
+            return err;
+        }
+        case NUS_CMD_NOISE:{
+            struct nus_noise_cmd cmd;
+            if (len < sizeof(cmd)) {
+                return -EMSGSIZE;
+            }
+            memcpy(&cmd, in, sizeof(cmd));
+
+            if (cmd.frames == 0) {
+                spectral_avg_noise_clear();
             } else {
-                printk("BT: T received but no note provided\n");
+                spectral_avg_noise_capture(cmd.frames);
+                printk("BT: learning noise over %u frames\n", cmd.frames);
+            }
+            return 0;
+        }
+        case NUS_CMD_SPEC_STREAM:{
+            struct nus_spec_stream_cmd cmd;
+            if (len < sizeof(cmd)) {
+                return -EMSGSIZE;
+            }
+            memcpy(&cmd, in, sizeof(cmd));
+
+            int err = spectrum_stream_set(&cmd);
+            printk("BT: spectrum stream %u bits, every %u, bins %u+%u -> %d\n",
+                   cmd.bits, cmd.every, cmd.first_bin, cmd.n_bins, err);
+            return err;
+        }
+        case NUS_CMD_AUDIO:{
+            struct nus_audio_cmd cmd;
+            if (len < sizeof(cmd)) {
+                return -EMSGSIZE;
+            }
+            memcpy(&cmd, in, sizeof(cmd));
+
+            int err = audio_capture_set(&cmd);
+            printk("BT: audio %s, decimation %u -> %d\n",
+                   cmd.on ? "on" : "off", cmd.decimation, err);
+            return err;
+        }
+        case NUS_CMD_RESOLUTION:{
+            struct nus_resolution_cmd cmd;
+            if (len < sizeof(cmd)) {
+                return -EMSGSIZE;
+            }
+            memcpy(&cmd, in, sizeof(cmd));
+
+            int err = multires_set(&cmd);
+            printk("BT: resolution %s, %u periods -> %d\n",
+                   cmd.mode == NUS_RES_MULTI ? "multi" : "fixed",
+                   cmd.periods, err);
+            return err;
+        }
+#if defined(CONFIG_APP_PITCH_LOG)
+        case NUS_CMD_LOG:{
+            struct nus_log_cmd cmd;
+            if (len < sizeof(cmd)) {
+                return -EMSGSIZE;
+            }
+            memcpy(&cmd, in, sizeof(cmd));
+
+            int err = pitch_log_command(&cmd);
+            printk("BT: log op %u arg %u -> %d\n", cmd.op, cmd.arg, err);
+            return err;
+        }
+        case NUS_CMD_LOG_CREDIT:{
+            struct nus_log_credit_cmd cmd;
+            if (len < sizeof(cmd)) {
+                return -EMSGSIZE;
             }
-            break;
+            memcpy(&cmd, in, sizeof(cmd));
+
+            pitch_log_credit(cmd.limit);
+            return 0;
         }
+#endif
         default:{
-            printk("BT: Unknown command '%c'\n", in[0]);
-            break;
+            printk("BT: Unknown command 0x%02x\n", in[0]);
+            return -ENOTSUP;
+        }
+    }
+}
+
+static void send_ack(uint8_t req_id, uint8_t cmd, int status)
+{
+    struct nus_ack_frame ack = {
+        .type   = NUS_FRAME_ACK,
+        .req_id = req_id,
+        .cmd    = cmd,
+        .status = (int8_t)CLAMP(status, INT8_MIN, 0),
+    };
+    nus_send(&ack, sizeof(ack));
+}
+
+static ssize_t on_nus_rx(struct bt_conn *conn,
+    const struct bt_gatt_attr *attr,
+    const void *buf, uint16_t len,
+    uint16_t offset, uint8_t flags){
+
+    /* Stamp first so the pong reflects arrival, not parsing */
+    uint32_t t_rx_us = nus_timestamp_us();
+    const uint8_t *in = buf;
+    if (len == 0){
+        return len;
+    }
+
+    if (in[0] == NUS_CMD_PING) {
+        if (len >= sizeof(struct nus_ping_cmd)) {
+            struct nus_pong_frame pong = {
+                .type        = NUS_FRAME_PONG,
+                .t_periph_us = t_rx_us,
+            };
+            memcpy(&pong.t_central_us, in + 1, sizeof(pong.t_central_us));
+            nus_send(&pong, sizeof(pong));
         }
+        return len;
     }
+
+    struct nus_req_hdr hdr;
+    if (in[0] != NUS_REQ || len <= sizeof(hdr)) {
+        printk("BT: unframed write 0x%02x (%u bytes) dropped\n", in[0], len);
+        return len;
+    }
+    memcpy(&hdr, in, sizeof(hdr));
+    in  += sizeof(hdr);
+    len -= sizeof(hdr);
+
+    for (uint8_t i = 0; i < req_history_len; i++) {
+        if (req_history[i].req_id == hdr.req_id &&
+            req_history[i].cmd == in[0]) {
+            send_ack(hdr.req_id, in[0], req_history[i].status);
+            return len + sizeof(hdr);
+        }
+    }
+
+    int status = handle_command(in, len);
+    req_history[req_history_next].req_id = hdr.req_id;
+    req_history[req_history_next].cmd    = in[0];
+    req_history[req_history_next].status = (int8_t)CLAMP(status, INT8_MIN, 0);
+    req_history_next = (req_history_next + 1) % REQ_HISTORY;
+    req_history_len  = MIN(req_history_len + 1, REQ_HISTORY);
+
+    send_ack(hdr.req_id, in[0], status);
+    return len + sizeof(hdr);
+}
+
+/* Loss counters, read by the central on demand */
+static ssize_t on_stats_read(struct bt_conn *conn,
+                             const struct bt_gatt_attr *attr,
+                             void *buf, uint16_t len, uint16_t offset)
+{
+    uint32_t ctr[NUS_PERIPH_CTR_COUNT];
+    loss_stats_snapshot(ctr);
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, ctr, sizeof(ctr));
 }
 
 /* Notification CCC configuration changed callback */
@@ -62,6 +352,7 @@ static void tx_ccc_cfg_changed(const struct bt_gatt_attr *attr,
 {
     uint16_t handle = bt_gatt_attr_get_handle(attr);
     bool enabled = (value == BT_GATT_CCC_NOTIFY);
+    tx_notify_enabled = enabled;
     printk("Notifications %s (handle 0x%04x)\n",
            enabled ? "enabled" : "disabled",
            handle);
@@ -88,11 +379,111 @@ BT_GATT_SERVICE_DEFINE(nus_svc,
 
     /* CCC for TX notifications */
     BT_GATT_CCC(tx_ccc_cfg_changed,
-                BT_GATT_PERM_READ | BT_GATT_PERM_WRITE)
+                BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+
+    /* Loss counters: NUS_PERIPH_CTR_COUNT x uint32_t (long read) */
+    BT_GATT_CHARACTERISTIC(
+        BT_UUID_DECLARE_128(NUS_STATS_CHAR_UUID_VAL),
+        BT_GATT_CHRC_READ,
+        BT_GATT_PERM_READ,
+        on_stats_read, NULL, NULL)
 );
 
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+    if (err) {
+        printk("BT: connection failed (0x%02x)\n", err);
+        return;
+    }
+    current_conn = bt_conn_ref(conn);
+    report_policy_reset();
+    subscription_reset();
+    link_profile_connected();
+    spectrum_stream_reset();
+    audio_capture_reset();
+#if defined(CONFIG_APP_PITCH_LOG)
+    pitch_log_link_reset();
+#endif
+    req_history_len = 0;
+    printk("BT: connected\n");
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+    printk("BT: disconnected (reason 0x%02x)\n", reason);
+    loss_stats_print();
+    link_profile_disconnected();
+    tx_notify_enabled = false;
+    if (current_conn) {
+        bt_conn_unref(current_conn);
+        current_conn = NULL;
+    }
+}
+
+static void le_param_updated(struct bt_conn *conn, uint16_t interval,
+                             uint16_t latency, uint16_t timeout)
+{
+    link_profile_updated(interval, latency, timeout);
+}
+
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+static void le_phy_updated(struct bt_conn *conn,
+                           struct bt_conn_le_phy_info *param)
+{
+    printk("BT: PHY now tx 0x%02x rx 0x%02x\n", param->tx_phy, param->rx_phy);
+}
+#endif
+
+BT_CONN_CB_DEFINE(conn_callbacks) = {
+    .connected        = connected,
+    .disconnected     = disconnected,
+    .le_param_updated = le_param_updated,
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+    .le_phy_updated   = le_phy_updated,
+#endif
+};
+
+int nus_send(const void *data, uint16_t len)
+{
+    if (!current_conn || !tx_notify_enabled) {
+        return -ENOTCONN;
+    }
+    return bt_gatt_notify(current_conn, nus_tx_attr, data, len);
+}
+
+int nus_send_cb(const void *data, uint16_t len, bt_gatt_complete_func_t done)
+{
+    if (!current_conn || !tx_notify_enabled) {
+        return -ENOTCONN;
+    }
+    struct bt_gatt_notify_params params = {
+        .attr = nus_tx_attr,
+        .data = data,
+        .len  = len,
+        .func = done,
+    };
+    return bt_gatt_notify_cb(current_conn, &params);
+}
+
+uint16_t nus_max_payload(void)
+{
+    struct bt_conn *conn = current_conn;
+    return conn ? bt_gatt_get_mtu(conn) - 3 : NUS_MAX_PAYLOAD;
+}
+
 void init_bluetooth(void)
 {
+    /* attrs: [0] service, [1..2] RX, [3] TX decl, [4] TX value, [5] CCC */
+    nus_tx_attr = &nus_svc.attrs[4];
+
+    if (sizeof(CONFIG_APP_SIM_ADDR) > 1) {
+        bt_addr_le_t addr;
+        if (bt_addr_le_from_str(CONFIG_APP_SIM_ADDR, "random", &addr) == 0) {
+            printk("bt_id_create(%s) -> %d\n", CONFIG_APP_SIM_ADDR,
+                   bt_id_create(&addr, NULL));
+        }
+    }
+
     int err = bt_enable(NULL);
     printk("bt_enable -> %d\n", err);
 
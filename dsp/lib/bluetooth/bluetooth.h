@@ -7,18 +7,25 @@
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/sys/printk.h>
 
+/* Tuner mode and target travel on tuner_config_chan (results_bus.h) */
 #define MAX_NOTE_LEN 4
-extern char target_note[MAX_NOTE_LEN];
 
 enum bt_mode{
     MODE_READ,
     MODE_TUNE
 };
 
-extern enum bt_mode current_mode;
-
 extern struct bt_conn *current_conn;
 extern const struct bt_gatt_attr *nus_tx_attr; 
 void init_bluetooth(void);
 
+/* Notify on NUS TX; -ENOTCONN when nobody is subscribed */
+int nus_send(const void *data, uint16_t len);
+
+/* As nus_send(), calling done once the stack has sent it */
+int nus_send_cb(const void *data, uint16_t len, bt_gatt_complete_func_t done);
+
+/* Largest notification the current link carries (ATT MTU - 3) */
+uint16_t nus_max_payload(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,367 @@
+/* WAV-fed DMIC emulator for native_sim / nrf52_bsim.
+ *
+ * Implements the Zephyr DMIC driver API so main.c runs unchanged: a
+ * k_timer ticks once per block period, the system work queue fills a
+ * mem_slab block from the WAV file and queues it for dmic_read(). A
+ * slow reader sees the same overruns as with the real PDM peripheral:
+ * when the slab or the queue is full the block is dropped and counted.
+ *
+ * The WAV file must be 16-bit PCM; extra channels are skipped (left is
+ * used) and the rate is taken as-is, so record at the DMIC rate. At end
+ * of file the data chunk loops.
+ */
+#define DT_DRV_COMPAT app_dmic_wav
+
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/audio/dmic.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "cmdline.h"
+#include "posix_native_task.h"
+#include "nsi_host_trampolines.h"
+
+LOG_MODULE_REGISTER(dmic_wav);
+
+#define DMIC_WAV_QUEUE_DEPTH 4
+#define HOST_O_RDONLY        0
+
+/* Synthetic source when no -wav is given: A2 with a 2 s pluck decay */
+#define SYNTH_FREQ_HZ   110.0f
+#define SYNTH_AMPLITUDE 8000.0f
+#define SYNTH_PERIOD_S  2.0f
+
+static char *wav_path;
+
+struct dmic_wav_data {
+    struct k_mem_slab *slab;
+    size_t    block_size;
+    uint32_t  pcm_rate;
+    bool      configured;
+    bool      running;
+
+    /* source */
+    int       fd;
+    uint16_t  channels;
+    uint32_t  data_offset;      /* first sample byte in the file */
+    uint32_t  data_len;
+    uint32_t  data_pos;
+    uint32_t  synth_n;
+
+    struct k_timer timer;
+    struct k_work  fill_work;
+    struct k_msgq  rx_q;
+    void          *rx_q_buf[DMIC_WAV_QUEUE_DEPTH];
+
+    uint32_t  overruns;
+};
+
+static int host_read_exact(int fd, void *buf, size_t len)
+{
+    uint8_t *p = buf;
+    while (len) {
+        long n = nsi_host_read(fd, p, len);
+        if (n <= 0) {
+            return -EIO;
+        }
+        p   += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int host_skip(int fd, uint32_t len)
+{
+    uint8_t scratch[64];
+    while (len) {
+        uint32_t n = MIN(len, sizeof(scratch));
+        if (host_read_exact(fd, scratch, n)) {
+            return -EIO;
+        }
+        len -= n;
+    }
+    return 0;
+}
+
+/* Walk the RIFF chunks up to "data"; leaves fd at the first sample */
+static int wav_open(struct dmic_wav_data *d)
+{
+    uint8_t hdr[12];
+    uint8_t chunk[8];
+    bool    have_fmt = false;
+
+    d->fd = nsi_host_open(wav_path, HOST_O_RDONLY);
+    if (d->fd < 0) {
+        LOG_ERR("cannot open %s", wav_path);
+        return -ENOENT;
+    }
+    if (host_read_exact(d->fd, hdr, sizeof(hdr)) ||
+        memcmp(hdr, "RIFF", 4) || memcmp(hdr + 8, "WAVE", 4)) {
+        goto bad;
+    }
+    d->data_offset = sizeof(hdr);
+
+    while (host_read_exact(d->fd, chunk, sizeof(chunk)) == 0) {
+        uint32_t len = sys_get_le32(chunk + 4);
+        d->data_offset += sizeof(chunk);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (len < sizeof(fmt) ||
+                host_read_exact(d->fd, fmt, sizeof(fmt)) ||
+                host_skip(d->fd, len - sizeof(fmt))) {
+                goto bad;
+            }
+            uint16_t format = sys_get_le16(fmt);
+            uint32_t rate   = sys_get_le32(fmt + 4);
+            uint16_t bits   = sys_get_le16(fmt + 14);
+            d->channels     = sys_get_le16(fmt + 2);
+            if (format != 1 || bits != 16 || d->channels == 0) {
+                LOG_ERR("%s: need 16-bit PCM", wav_path);
+                goto bad;
+            }
+            if (rate != d->pcm_rate) {
+                LOG_WRN("%s is %u Hz, DMIC runs at %u Hz; not resampled",
+                        wav_path, rate, d->pcm_rate);
+            }
+            have_fmt = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_fmt || len == 0) {
+                goto bad;
+            }
+            d->data_len = len - len % (2 * d->channels);
+            d->data_pos = 0;
+            return 0;
+        } else if (host_skip(d->fd, len + (len & 1))) {
+            goto bad;
+        }
+        d->data_offset += len + (len & 1);
+    }
+
+bad:
+    LOG_ERR("%s: not a usable WAV file", wav_path);
+    nsi_host_close(d->fd);
+    d->fd = -1;
+    return -EINVAL;
+}
+
+/* No seek among the host trampolines: loop by reopening and skipping
+ * to the data chunk */
+static int wav_rewind(struct dmic_wav_data *d)
+{
+    nsi_host_close(d->fd);
+    d->fd = nsi_host_open(wav_path, HOST_O_RDONLY);
+    if (d->fd < 0 || host_skip(d->fd, d->data_offset)) {
+        return -EIO;
+    }
+    d->data_pos = 0;
+    return 0;
+}
+
+static void wav_fill(struct dmic_wav_data *d, int16_t *out, size_t samples)
+{
+    int16_t frame[8];
+    size_t  frame_bytes = 2 * MIN(d->channels, ARRAY_SIZE(frame));
+    size_t  skip_bytes  = 2 * d->channels - frame_bytes;
+
+    for (size_t i = 0; i < samples; i++) {
+        if (d->data_pos >= d->data_len && wav_rewind(d)) {
+            memset(&out[i], 0, (samples - i) * sizeof(*out));
+            return;
+        }
+        if (host_read_exact(d->fd, frame, frame_bytes) ||
+            host_skip(d->fd, skip_bytes)) {
+            d->data_pos = d->data_len;
+            out[i] = 0;
+            continue;
+        }
+        out[i] = (int16_t)sys_le16_to_cpu(frame[0]);
+        d->data_pos += 2 * d->channels;
+    }
+}
+
+static void synth_fill(struct dmic_wav_data *d, int16_t *out, size_t samples)
+{
+    uint32_t period = (uint32_t)(SYNTH_PERIOD_S * d->pcm_rate);
+
+    for (size_t i = 0; i < samples; i++, d->synth_n++) {
+        float t   = (float)(d->synth_n % period) / (float)d->pcm_rate;
+        float env = expf(-2.0f * t);
+        out[i] = (int16_t)(SYNTH_AMPLITUDE * env *
+                           sinf(2.0f * (float)M_PI * SYNTH_FREQ_HZ * t));
+    }
+}
+
+static void fill_work_handler(struct k_work *work)
+{
+    struct dmic_wav_data *d = CONTAINER_OF(work, struct dmic_wav_data,
+                                           fill_work);
+    void *block;
+
+    if (!d->running) {
+        return;
+    }
+    if (k_mem_slab_alloc(d->slab, &block, K_NO_WAIT) != 0) {
+        d->overruns++;
+        return;
+    }
+
+    size_t samples = d->block_size / sizeof(int16_t);
+    if (d->fd >= 0) {
+        wav_fill(d, block, samples);
+    } else {
+        synth_fill(d, block, samples);
+    }
+
+    if (k_msgq_put(&d->rx_q, &block, K_NO_WAIT) != 0) {
+        k_mem_slab_free(d->slab, block);
+        d->overruns++;
+    }
+}
+
+static void block_timer_handler(struct k_timer *timer)
+{
+    struct dmic_wav_data *d = k_timer_user_data_get(timer);
+
+    k_work_submit(&d->fill_work);
+}
+
+static int dmic_wav_configure(const struct device *dev, struct dmic_cfg *cfg)
+{
+    struct dmic_wav_data *d = dev->data;
+    struct pcm_stream_cfg *stream = &cfg->streams[0];
+
+    if (d->running) {
+        return -EBUSY;
+    }
+    if (cfg->channel.req_num_streams != 1 || cfg->channel.req_num_chan != 1 ||
+        stream->pcm_width != 16 || stream->pcm_rate == 0) {
+        return -EINVAL;
+    }
+    if (stream->block_size > stream->mem_slab->info.block_size) {
+        LOG_ERR("block_size %u exceeds slab block %u",
+                (unsigned)stream->block_size,
+                (unsigned)stream->mem_slab->info.block_size);
+        return -EINVAL;
+    }
+
+    d->slab       = stream->mem_slab;
+    d->block_size = stream->block_size;
+    d->pcm_rate   = stream->pcm_rate;
+
+    cfg->channel.act_num_streams = 1;
+    cfg->channel.act_num_chan    = 1;
+    cfg->channel.act_chan_map_lo = cfg->channel.req_chan_map_lo;
+    cfg->channel.act_chan_map_hi = cfg->channel.req_chan_map_hi;
+
+    if (d->fd < 0 && wav_path) {
+        wav_open(d);
+    }
+    if (d->fd < 0) {
+        LOG_INF("no WAV source, using synthetic %.0f Hz pluck",
+                (double)SYNTH_FREQ_HZ);
+    }
+    d->configured = true;
+    return 0;
+}
+
+static int dmic_wav_trigger(const struct device *dev, enum dmic_trigger cmd)
+{
+    struct dmic_wav_data *d = dev->data;
+
+    switch (cmd) {
+    case DMIC_TRIGGER_START:
+    case DMIC_TRIGGER_RELEASE: {
+        if (!d->configured) {
+            return -EIO;
+        }
+        uint32_t period_us = (uint32_t)((uint64_t)d->block_size /
+                                        sizeof(int16_t) * USEC_PER_SEC /
+                                        d->pcm_rate);
+        d->running = true;
+        k_timer_start(&d->timer, K_USEC(period_us), K_USEC(period_us));
+        return 0;
+    }
+    case DMIC_TRIGGER_STOP:
+    case DMIC_TRIGGER_PAUSE:
+    case DMIC_TRIGGER_RESET: {
+        void *block;
+
+        d->running = false;
+        k_timer_stop(&d->timer);
+        while (k_msgq_get(&d->rx_q, &block, K_NO_WAIT) == 0) {
+            k_mem_slab_free(d->slab, block);
+        }
+        if (d->overruns) {
+            LOG_WRN("%u blocks dropped, reader too slow", d->overruns);
+        }
+        return 0;
+    }
+    default:
+        return -EINVAL;
+    }
+}
+
+static int dmic_wav_read(const struct device *dev, uint8_t stream,
+                         void **buffer, size_t *size, int32_t timeout)
+{
+    struct dmic_wav_data *d = dev->data;
+
+    if (!d->running) {
+        return -EIO;
+    }
+    int err = k_msgq_get(&d->rx_q, buffer, SYS_TIMEOUT_MS(timeout));
+    if (err) {
+        *buffer = NULL;
+        return err;
+    }
+    *size = d->block_size;
+    return 0;
+}
+
+static const struct _dmic_ops dmic_wav_ops = {
+    .configure = dmic_wav_configure,
+    .trigger   = dmic_wav_trigger,
+    .read      = dmic_wav_read,
+};
+
+static int dmic_wav_init(const struct device *dev)
+{
+    struct dmic_wav_data *d = dev->data;
+
+    d->fd = -1;
+    k_msgq_init(&d->rx_q, (char *)d->rx_q_buf, sizeof(void *),
+                DMIC_WAV_QUEUE_DEPTH);
+    k_work_init(&d->fill_work, fill_work_handler);
+    k_timer_init(&d->timer, block_timer_handler, NULL);
+    k_timer_user_data_set(&d->timer, d);
+    return 0;
+}
+
+static void dmic_wav_options(void)
+{
+    static struct args_struct_t opts[] = {
+        {
+            .option   = "wav",
+            .name     = "path",
+            .type     = 's',
+            .dest     = (void *)&wav_path,
+            .descript = "16-bit PCM WAV file streamed by the emulated DMIC",
+        },
+        ARG_TABLE_ENDMARKER
+    };
+
+    native_add_command_line_opts(opts);
+}
+NATIVE_TASK(dmic_wav_options, PRE_BOOT_1, 1);
+
+#define DMIC_WAV_DEFINE(inst)                                           \
+    static struct dmic_wav_data dmic_wav_data_##inst;                   \
+    DEVICE_DT_INST_DEFINE(inst, dmic_wav_init, NULL,                    \
+                          &dmic_wav_data_##inst, NULL, POST_KERNEL,     \
+                          CONFIG_AUDIO_DMIC_INIT_PRIORITY, &dmic_wav_ops);
+
+DT_INST_FOREACH_STATUS_OKAY(DMIC_WAV_DEFINE)
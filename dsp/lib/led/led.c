@@ -0,0 +1,126 @@
+#include "led.h"
+
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_sx1509b.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(led);
+
+#define NUMBER_OF_LEDS 3
+
+/* Boards without the Thingy:52 expander (e.g. nrf52_bsim) get no LEDs;
+ * led_init() fails and every update is dropped at submit time */
+#define LED_HW DT_NODE_EXISTS(DT_NODELABEL(sx1509b))
+
+#if LED_HW
+#define RED_LED   DT_GPIO_PIN(DT_NODELABEL(led0), gpios)
+#define GREEN_LED DT_GPIO_PIN(DT_NODELABEL(led1), gpios)
+#define BLUE_LED  DT_GPIO_PIN(DT_NODELABEL(led2), gpios)
+#else
+#define RED_LED   0
+#define GREEN_LED 0
+#define BLUE_LED  0
+#endif
+
+/* Gradient is quantised so cent-level jitter doesn't rewrite the LEDs */
+#define LED_GRADIENT_LEVELS 16
+
+#define LED_WQ_STACK_SIZE 768
+#define LED_WQ_PRIORITY   9     /* below the DSP thread */
+
+static const struct device *sx1509b_dev;
+static const gpio_pin_t rgb_pins[NUMBER_OF_LEDS] = {
+    RED_LED,
+    GREEN_LED,
+    BLUE_LED,
+};
+
+K_THREAD_STACK_DEFINE(led_wq_stack, LED_WQ_STACK_SIZE);
+static struct k_work_q led_wq;
+static struct k_work   led_work;
+
+static struct k_spinlock lock;
+static uint8_t wanted[NUMBER_OF_LEDS];              /* last requested */
+static int16_t shown[NUMBER_OF_LEDS] = { -1, -1, -1 }; /* work queue only */
+
+static void led_work_handler(struct k_work *work)
+{
+    uint8_t want[NUMBER_OF_LEDS];
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    memcpy(want, wanted, sizeof(want));
+    k_spin_unlock(&lock, key);
+
+    for (int i = 0; i < NUMBER_OF_LEDS; i++) {
+        if (shown[i] == want[i]) {
+            continue;
+        }
+#if LED_HW
+        if (sx1509b_led_intensity_pin_set(sx1509b_dev, rgb_pins[i],
+                                          want[i]) == 0) {
+            shown[i] = want[i];
+        }
+#endif
+    }
+}
+
+void led_set_rgb(uint8_t red, uint8_t green, uint8_t blue)
+{
+    const uint8_t rgb[NUMBER_OF_LEDS] = { red, green, blue };
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool dirty = memcmp(wanted, rgb, sizeof(rgb)) != 0;
+    memcpy(wanted, rgb, sizeof(rgb));
+    k_spin_unlock(&lock, key);
+
+    /* No-op if the work is already queued: the handler reads the
+     * latest `wanted`, so bursts collapse into one update */
+    if (dirty) {
+        k_work_submit_to_queue(&led_wq, &led_work);
+    }
+}
+
+void led_show_cents(float cents)
+{
+    float err = fminf(fabsf(cents) / LED_CENTS_FULL_RED, 1.0f);
+    uint8_t level = (uint8_t)lroundf(err * (LED_GRADIENT_LEVELS - 1));
+    uint8_t red = level * (255 / (LED_GRADIENT_LEVELS - 1));
+
+    led_set_rgb(red, 255 - red, 0);
+}
+
+int led_init(void)
+{
+    k_work_init(&led_work, led_work_handler);
+
+#if LED_HW
+    int err;
+
+    sx1509b_dev = DEVICE_DT_GET(DT_NODELABEL(sx1509b));
+    if (!device_is_ready(sx1509b_dev)) {
+        LOG_DBG("sx1509b: device not ready.\n");
+        return -ENODEV;
+    }
+    for (int i = 0; i < NUMBER_OF_LEDS; i++) {
+        err = sx1509b_led_intensity_pin_configure(sx1509b_dev, rgb_pins[i]);
+        if (err) {
+            LOG_DBG("Error configuring pin for LED intensity\n");
+            return -ENODEV;
+        }
+    }
+#else
+    LOG_INF("no sx1509b on this board, LEDs disabled");
+    return -ENODEV;
+#endif
+
+    const struct k_work_queue_config wq_cfg = { .name = "led_wq" };
+
+    k_work_queue_init(&led_wq);
+    k_work_queue_start(&led_wq, led_wq_stack,
+                       K_THREAD_STACK_SIZEOF(led_wq_stack),
+                       LED_WQ_PRIORITY, &wq_cfg);
+    return 0;
+}
@@ -0,0 +1,24 @@
+#ifndef LED_H
+#define LED_H
+
+#include <stdint.h>
+
+/* Thingy:52 RGB LED behind the SX1509B expander.
+ *
+ * All I2C traffic happens on the LED module's own work queue. Callers
+ * only record the colour they want: requests that arrive before the
+ * queue runs collapse into one update, and a channel is written only
+ * when its value differs from what the expander already shows. None of
+ * the calls below block.
+ */
+
+/* Cents error at (or beyond) which the tuning display is fully red */
+#define LED_CENTS_FULL_RED 50.0f
+
+int  led_init(void);
+void led_set_rgb(uint8_t red, uint8_t green, uint8_t blue);
+
+/* Tuning display: green when in tune, fading to red as |cents| grows */
+void led_show_cents(float cents);
+
+#endif /* LED_H */
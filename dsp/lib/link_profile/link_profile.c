@@ -0,0 +1,150 @@
+#include "link_profile.h"
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+/* Give the central time to finish discovery on its own parameters */
+#define CONNECT_SETTLE_MS 1000
+/* A refused update (e.g. one still in progress) is tried again after this */
+#define RETRY_MS          500
+
+struct link_profile {
+    const char              *name;
+    struct bt_le_conn_param  param;   /* 1.25 ms / 10 ms units */
+    struct bt_conn_le_phy_param phy;
+};
+
+#define PHY(p, opt) { .options = (opt), .pref_tx_phy = (p), .pref_rx_phy = (p) }
+
+static const struct link_profile profiles[NUS_LINK_PROFILE_COUNT] = {
+    [NUS_LINK_FAST] = {
+        "fast",     BT_LE_CONN_PARAM_INIT(6, 12, 0, 100),
+        PHY(BT_GAP_LE_PHY_2M, BT_CONN_LE_PHY_OPT_NONE),
+    },
+    [NUS_LINK_BALANCED] = {
+        "balanced", BT_LE_CONN_PARAM_INIT(24, 40, 0, 400),
+        PHY(BT_GAP_LE_PHY_1M, BT_CONN_LE_PHY_OPT_NONE),
+    },
+    [NUS_LINK_LOWPOWER] = {
+        "lowpower", BT_LE_CONN_PARAM_INIT(80, 160, 4, 600),
+        PHY(BT_GAP_LE_PHY_1M, BT_CONN_LE_PHY_OPT_NONE),
+    },
+    [NUS_LINK_RANGE] = {
+        "range",    BT_LE_CONN_PARAM_INIT(40, 80, 0, 600),
+        PHY(BT_GAP_LE_PHY_CODED, BT_CONN_LE_PHY_OPT_CODED_S8),
+    },
+};
+
+static uint8_t requested = NUS_LINK_AUTO;
+static enum bt_mode mode = MODE_READ;
+static bool audio;
+static uint8_t applied = NUS_LINK_PROFILE_COUNT;   /* none yet */
+
+/* requested/mode/audio are written from the BT RX thread, read from the
+ * system work queue */
+static struct k_spinlock lock;
+
+static void apply_handler(struct k_work *work)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint8_t id = requested;
+    if (id == NUS_LINK_AUTO) {
+        id = (mode == MODE_TUNE || audio) ? NUS_LINK_FAST : NUS_LINK_BALANCED;
+    }
+    bool same = (id == applied);
+    k_spin_unlock(&lock, key);
+
+    struct bt_conn *conn = current_conn;
+    if (same || !conn) {
+        return;
+    }
+
+    const struct link_profile *p = &profiles[id];
+    int err = bt_conn_le_param_update(conn, &p->param);
+    printk("BT: link %s: interval %u-%u latency %u timeout %u -> %d\n",
+           p->name, p->param.interval_min, p->param.interval_max,
+           p->param.latency, p->param.timeout, err);
+    if (err && err != -EALREADY) {
+        /* Not applied: leave applied alone so the retry sends it */
+        k_work_reschedule(k_work_delayable_from_work(work),
+                          K_MSEC(RETRY_MS));
+        return;
+    }
+
+    key = k_spin_lock(&lock);
+    applied = id;
+    k_spin_unlock(&lock, key);
+
+    /* Not every controller has 2M or Coded; the parameters still apply */
+    err = bt_conn_le_phy_update(conn, &p->phy);
+    if (err) {
+        printk("BT: link %s: PHY 0x%02x not requested (%d)\n",
+               p->name, p->phy.pref_tx_phy, err);
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE(apply_work, apply_handler);
+
+void link_profile_connected(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    requested = NUS_LINK_AUTO;
+    applied   = NUS_LINK_PROFILE_COUNT;
+    audio     = false;
+    k_spin_unlock(&lock, key);
+
+    k_work_reschedule(&apply_work, K_MSEC(CONNECT_SETTLE_MS));
+}
+
+void link_profile_disconnected(void)
+{
+    k_work_cancel_delayable(&apply_work);
+}
+
+int link_profile_request(uint8_t profile)
+{
+    if (profile >= NUS_LINK_PROFILE_COUNT && profile != NUS_LINK_AUTO) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    requested = profile;
+    k_spin_unlock(&lock, key);
+
+    /* Keep a pending post-connect delay; otherwise apply now */
+    k_work_schedule(&apply_work, K_NO_WAIT);
+    return 0;
+}
+
+void link_profile_mode(enum bt_mode new_mode)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    mode = new_mode;
+    bool follow = (requested == NUS_LINK_AUTO);
+    k_spin_unlock(&lock, key);
+
+    if (follow) {
+        k_work_schedule(&apply_work, K_NO_WAIT);
+    }
+}
+
+void link_profile_audio(bool on)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    audio = on;
+    bool follow = (requested == NUS_LINK_AUTO);
+    k_spin_unlock(&lock, key);
+
+    if (follow) {
+        k_work_schedule(&apply_work, K_NO_WAIT);
+    }
+}
+
+void link_profile_updated(uint16_t interval, uint16_t latency,
+                          uint16_t timeout)
+{
+    printk("BT: link now interval %u.%02u ms latency %u timeout %u ms\n",
+           interval * 125 / 100, interval * 125 % 100, latency,
+           timeout * 10);
+}
@@ -0,0 +1,38 @@
+#ifndef LINK_PROFILE_H
+#define LINK_PROFILE_H
+
+#include <stdint.h>
+#include <zephyr/bluetooth/conn.h>
+#include "bluetooth.h"
+#include "nus_proto.h"
+
+/* Connection parameters and PHY for the NUS link.
+ *
+ * Each enum nus_link_profile names an interval range, peripheral
+ * latency, supervision timeout and preferred PHY. The peripheral asks
+ * for them with bt_conn_le_param_update()/bt_conn_le_phy_update(); the
+ * central decides what it actually grants, reported through
+ * link_profile_updated(). In NUS_LINK_AUTO the profile follows the
+ * tuner mode, and raw audio capture holds it on the fast profile. A
+ * fixed profile from the central holds until it asks for auto again or
+ * the link drops.
+ */
+
+/* New link: back to auto, negotiate once discovery has settled */
+void link_profile_connected(void);
+void link_profile_disconnected(void);
+
+/* NUS_CMD_LINK from the central; -EINVAL for an unknown profile */
+int link_profile_request(uint8_t profile);
+
+/* Tuner mode changed; only acts in auto */
+void link_profile_mode(enum bt_mode mode);
+
+/* Raw audio capture started/stopped; only acts in auto */
+void link_profile_audio(bool on);
+
+/* What the controllers settled on, for the log */
+void link_profile_updated(uint16_t interval, uint16_t latency,
+                          uint16_t timeout);
+
+#endif /* LINK_PROFILE_H */
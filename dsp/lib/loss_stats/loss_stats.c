@@ -0,0 +1,28 @@
+#include "loss_stats.h"
+
+#include <zephyr/sys/printk.h>
+
+atomic_t loss_ctr[NUS_PERIPH_CTR_COUNT];
+
+#define CTR_NAME(id, name) [id] = name,
+static const char *const names[NUS_PERIPH_CTR_COUNT] = {
+    NUS_PERIPH_COUNTERS(CTR_NAME)
+};
+#undef CTR_NAME
+
+void loss_stats_snapshot(uint32_t out[NUS_PERIPH_CTR_COUNT])
+{
+    for (int i = 0; i < NUS_PERIPH_CTR_COUNT; i++) {
+        out[i] = (uint32_t)atomic_get(&loss_ctr[i]);
+    }
+}
+
+void loss_stats_print(void)
+{
+    for (int i = 0; i < NUS_PERIPH_CTR_COUNT; i++) {
+        uint32_t v = (uint32_t)atomic_get(&loss_ctr[i]);
+        if (v) {
+            printk("  %-34s %u\n", names[i], v);
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef LOSS_STATS_H
+#define LOSS_STATS_H
+
+#include <stdint.h>
+#include <zephyr/sys/atomic.h>
+#include "nus_proto.h"
+
+/* Where blocks and frames go missing on the peripheral.
+ *
+ * One counter per point in the capture -> DSP -> BLE chain where data
+ * can be dropped or held back, plus the totals needed to turn them into
+ * rates. Counters are lock-free and may be bumped from any thread; the
+ * list itself lives in nus_proto.h so the central can name them when it
+ * reads the stats characteristic.
+ */
+extern atomic_t loss_ctr[NUS_PERIPH_CTR_COUNT];
+
+static inline void loss_stats_inc(enum nus_periph_ctr id)
+{
+    atomic_inc(&loss_ctr[id]);
+}
+
+static inline void loss_stats_add(enum nus_periph_ctr id, uint32_t n)
+{
+    atomic_add(&loss_ctr[id], n);
+}
+
+/* Copy all counters in list order, as sent over the air */
+void loss_stats_snapshot(uint32_t out[NUS_PERIPH_CTR_COUNT]);
+
+/* Print every non-zero counter */
+void loss_stats_print(void);
+
+#endif /* LOSS_STATS_H */
@@ -0,0 +1,222 @@
+#include "multires.h"
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#define DECIM_FACTOR 4
+#define DECIM_TAPS   32
+#define DECIM_CHUNK  160            /* 10 ms at 16 kHz, divides a block */
+
+/* Zoom band: +-MR_SPAN_CENTS in MR_STEP_CENTS steps */
+#define MR_SPAN_CENTS 100
+#define MR_STEP_CENTS 5
+#define MR_POINTS     (2 * MR_SPAN_CENTS / MR_STEP_CENTS + 1)
+
+#define HIST_MASK (MULTIRES_HIST_LEN - 1)
+
+BUILD_ASSERT((MULTIRES_HIST_LEN & HIST_MASK) == 0,
+             "history index wraps with a mask");
+BUILD_ASSERT(2 * MULTIRES_MAX_LEN <= MULTIRES_HIST_LEN,
+             "history covers the longest window a block back");
+
+/* Hamming-windowed sinc, fc 1.6 kHz at 16 kHz: -17 dB at the new
+ * Nyquist, -64 dB from 3.5 kHz where aliases would land on the strings */
+static const float32_t decim_taps[DECIM_TAPS] = {
+    -5.07108001e-04f, +6.05885435e-04f, +2.23462908e-03f, +4.13205744e-03f,
+    +4.98965984e-03f, +2.77610637e-03f, -3.93256487e-03f, -1.42335562e-02f,
+    -2.38801600e-02f, -2.59324993e-02f, -1.32654962e-02f, +1.79379816e-02f,
+    +6.53379057e-02f, +1.19829196e-01f, +1.67867385e-01f, +1.96040578e-01f,
+    +1.96040578e-01f, +1.67867385e-01f, +1.19829196e-01f, +6.53379057e-02f,
+    +1.79379816e-02f, -1.32654962e-02f, -2.59324993e-02f, -2.38801600e-02f,
+    -1.42335562e-02f, -3.93256487e-03f, +2.77610637e-03f, +4.98965984e-03f,
+    +4.13205744e-03f, +2.23462908e-03f, +6.05885435e-04f, -5.07108001e-04f
+};
+
+static uint8_t mode    = MULTIRES_FIXED;
+static uint8_t periods = MULTIRES_PERIODS_DEF;
+static bool    usable;
+
+/* mode/periods are written from the BT RX thread, read from the DSP
+ * thread */
+static struct k_spinlock lock;
+
+/* Decimator and history, DSP thread only */
+static arm_fir_decimate_instance_f32 decim;
+static float32_t decim_state[DECIM_TAPS + DECIM_CHUNK - 1];
+static float32_t chunk_in[DECIM_CHUNK];
+static float32_t chunk_out[DECIM_CHUNK / DECIM_FACTOR];
+static float32_t hist[MULTIRES_HIST_LEN];
+static uint16_t  hist_head;         /* next write */
+static uint16_t  hist_fill;
+static uint32_t  last_capture_us;
+static bool      have_last;
+
+static float32_t windowed[MULTIRES_HIST_LEN];
+static float32_t power[MR_POINTS];
+
+int multires_init(uint32_t pcm_rate)
+{
+    if (pcm_rate != DECIM_FACTOR * MULTIRES_RATE_HZ) {
+        printk("DSP: multi-resolution needs %u Hz input, off\n",
+               DECIM_FACTOR * MULTIRES_RATE_HZ);
+        return -ENOTSUP;
+    }
+    if (arm_fir_decimate_init_f32(&decim, DECIM_TAPS, DECIM_FACTOR,
+                                  (float32_t *)decim_taps, decim_state,
+                                  DECIM_CHUNK) != ARM_MATH_SUCCESS) {
+        return -EINVAL;
+    }
+    usable = true;
+    return 0;
+}
+
+int multires_set(const struct nus_resolution_cmd *cmd)
+{
+    if (cmd->mode != MULTIRES_FIXED && cmd->mode != MULTIRES_MULTI) {
+        return -EINVAL;
+    }
+    if (cmd->mode == MULTIRES_MULTI &&
+        (cmd->periods < MULTIRES_PERIODS_MIN ||
+         cmd->periods > MULTIRES_PERIODS_MAX)) {
+        return -EINVAL;
+    }
+    if (!usable) {
+        return cmd->mode == MULTIRES_FIXED ? 0 : -ENOTSUP;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    mode = cmd->mode;
+    if (cmd->mode == MULTIRES_MULTI) {
+        periods = cmd->periods;
+    }
+    k_spin_unlock(&lock, key);
+    return 0;
+}
+
+static bool multi_on(uint8_t *n_periods)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool on = usable && mode == MULTIRES_MULTI;
+    *n_periods = periods;
+    k_spin_unlock(&lock, key);
+    return on;
+}
+
+static void history_restart(void)
+{
+    hist_fill = 0;
+    memset(decim_state, 0, sizeof(decim_state));
+}
+
+void multires_push(const int16_t *pcm, size_t n, uint32_t t_capture_us)
+{
+    uint8_t unused;
+    if (!multi_on(&unused)) {
+        have_last = false;
+        return;
+    }
+
+    /* A dropped block would splice two stretches of signal together */
+    uint32_t block_us = (uint32_t)(n * 1000000ULL /
+                                   (DECIM_FACTOR * MULTIRES_RATE_HZ));
+    if (!have_last ||
+        t_capture_us - last_capture_us > block_us + block_us / 2) {
+        history_restart();
+    }
+    last_capture_us = t_capture_us;
+    have_last = true;
+
+    for (size_t off = 0; off + DECIM_CHUNK <= n; off += DECIM_CHUNK) {
+        for (uint16_t i = 0; i < DECIM_CHUNK; i++) {
+            chunk_in[i] = (float32_t)pcm[off + i];
+        }
+        arm_fir_decimate_f32(&decim, chunk_in, chunk_out, DECIM_CHUNK);
+
+        for (uint16_t i = 0; i < ARRAY_SIZE(chunk_out); i++) {
+            hist[hist_head] = chunk_out[i];
+            hist_head = (hist_head + 1) & HIST_MASK;
+        }
+        hist_fill = MIN(hist_fill + ARRAY_SIZE(chunk_out),
+                        MULTIRES_HIST_LEN);
+    }
+}
+
+/* Decimated samples in n_periods of string_hz, within the limits */
+static uint32_t window_n(uint8_t n_periods, float32_t string_hz)
+{
+    uint32_t n = (uint32_t)(n_periods * MULTIRES_RATE_HZ / string_hz + 0.5f);
+    return CLAMP(n, MULTIRES_MIN_LEN, MULTIRES_MAX_LEN);
+}
+
+uint32_t multires_window_len(float32_t string_hz)
+{
+    uint8_t n_periods;
+    if (!multi_on(&n_periods) || string_hz <= 0.0f) {
+        return 0;
+    }
+    return window_n(n_periods, string_hz) * DECIM_FACTOR;
+}
+
+bool multires_measure(float32_t string_hz, float32_t approx_hz,
+                      uint32_t lag, float32_t *out_hz)
+{
+    uint8_t n_periods;
+    if (!multi_on(&n_periods) || string_hz <= 0.0f || approx_hz <= 0.0f) {
+        return false;
+    }
+
+    uint32_t n = window_n(n_periods, string_hz);
+    uint32_t back = lag / DECIM_FACTOR;
+    if (back > MULTIRES_MAX_LEN || hist_fill < n + back) {
+        return false;
+    }
+
+    /* The n samples up to the FFT window's end, oldest first, Hann
+     * windowed */
+    uint16_t start = (hist_head - back - n) & HIST_MASK;
+    float32_t w_step = 2.0f * PI / (float32_t)(n - 1);
+    for (uint32_t i = 0; i < n; i++) {
+        windowed[i] = hist[(start + i) & HIST_MASK] *
+                      (0.5f - 0.5f * arm_cos_f32(w_step * (float32_t)i));
+    }
+
+    /* Goertzel power at each point of the zoom band */
+    uint8_t best = 0;
+    for (uint8_t j = 0; j < MR_POINTS; j++) {
+        float32_t f = approx_hz *
+                      exp2f((float32_t)((int)j - MR_POINTS / 2) *
+                            MR_STEP_CENTS / 1200.0f);
+        float32_t coeff = 2.0f * arm_cos_f32(2.0f * PI * f /
+                                             MULTIRES_RATE_HZ);
+        float32_t s1 = 0.0f, s2 = 0.0f;
+        for (uint32_t i = 0; i < n; i++) {
+            float32_t s = windowed[i] + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s;
+        }
+        power[j] = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+        if (power[j] > power[best]) {
+            best = j;
+        }
+    }
+    if (best == 0 || best == MR_POINTS - 1) {
+        return false;
+    }
+
+    /* Hann main lobe is close to a Gaussian: a parabola through the log
+     * powers puts the peak well inside one step */
+    float32_t a = logf(power[best - 1] + 1e-20f);
+    float32_t b = logf(power[best] + 1e-20f);
+    float32_t c = logf(power[best + 1] + 1e-20f);
+    float32_t den = a - 2.0f * b + c;
+    float32_t d = (den < 0.0f) ? 0.5f * (a - c) / den : 0.0f;
+
+    *out_hz = approx_hz *
+              exp2f(((float32_t)((int)best - MR_POINTS / 2) + d) *
+                    MR_STEP_CENTS / 1200.0f);
+    return true;
+}
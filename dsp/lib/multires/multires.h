@@ -0,0 +1,69 @@
+#ifndef MULTIRES_H
+#define MULTIRES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "arm_math.h"
+#include "nus_proto.h"
+
+/* Constant-Q refinement of the detected pitch.
+ *
+ * The 1024-point FFT at 16 kHz gives every string the same 64 ms
+ * window: too short to resolve low E (82 Hz, ~5 periods) and longer
+ * than high E needs. This stage keeps a 4 kHz copy of the microphone
+ * stream (decimated 4:1, 256 ms deep) and, once the FFT has named a
+ * string, measures it again over a window of a fixed number of that
+ * string's periods, ending where the FFT window ends. At the default
+ * 16 that is ~48 ms for high E; the low strings would want up to
+ * ~194 ms, but a window never spans more than one 100 ms block, so a
+ * refined reading describes sound at most ~18 ms older than the FFT's.
+ * The measurement is a bank of Goertzel filters 5 cents apart, +-100
+ * cents around the FFT estimate, with the peak interpolated on log
+ * power, so only the band around one string is ever computed.
+ *
+ * It sharpens the reading, and in MODE_TUNE it can add some: when the
+ * target string's window fits twice into a block (the high strings),
+ * src/main.c also measures it at points between the FFT windows, so
+ * those strings report every ~33 ms instead of once per FFT window.
+ * Everything else still comes at the analysis rate the central
+ * subscribed to.
+ *
+ * The stage is off (MULTIRES_FIXED) until the central asks for it.
+ *
+ * Only the DSP thread may call multires_push() and multires_measure().
+ */
+#define MULTIRES_RATE_HZ      4000
+#define MULTIRES_HIST_LEN     1024      /* power of two, 256 ms */
+#define MULTIRES_MIN_LEN      64
+#define MULTIRES_MAX_LEN      (MULTIRES_RATE_HZ / 10)   /* one block */
+#define MULTIRES_PERIODS_MIN  4
+#define MULTIRES_PERIODS_MAX  32
+#define MULTIRES_PERIODS_DEF  16
+
+enum multires_mode {
+    MULTIRES_FIXED = NUS_RES_FIXED,     /* FFT estimate only */
+    MULTIRES_MULTI = NUS_RES_MULTI,
+};
+
+/* Before the DSP thread runs; the decimator expects 16 kHz input */
+int  multires_init(uint32_t pcm_rate);
+
+/* Any thread; -EINVAL for an unknown mode or periods out of range */
+int  multires_set(const struct nus_resolution_cmd *cmd);
+
+/* DSP thread: every block claimed from the microphone, in order */
+void multires_push(const int16_t *pcm, size_t n, uint32_t t_capture_us);
+
+/* Input samples a measurement of string_hz spans, 0 when off */
+uint32_t multires_window_len(float32_t string_hz);
+
+/* DSP thread: re-measure a pitch near approx_hz over periods of
+ * string_hz, in a window ending lag input samples before the newest
+ * one pushed (where the FFT window being refined ends). False when
+ * off, the history is still short, or the peak sits on the edge of
+ * the band (the FFT estimate was off by more). */
+bool multires_measure(float32_t string_hz, float32_t approx_hz,
+                      uint32_t lag, float32_t *out_hz);
+
+#endif /* MULTIRES_H */
@@ -0,0 +1,173 @@
+#include "peak_picker.h"
+
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+
+#define DEFAULT_MIN_SNR_DB     6.0f
+#define DEFAULT_FULL_SNR_DB    30.0f
+#define DEFAULT_MIN_CONFIDENCE 0.3f
+
+/* Floor tracking per frame (~10 frames/s): drop to a quieter bin within
+ * a few frames, creep up over ~5 s. Only an accepted peak is kept out of
+ * the update; a rejected one is left to rise into the floor on purpose,
+ * which is how a steady in-band hum stops winning. */
+#define FLOOR_FALL   0.25f
+#define FLOOR_RISE   0.02f
+#define FLOOR_MIN    1.0f
+/* Bins either side of an accepted peak left out of the floor update */
+#define PEAK_GUARD_BINS 2
+/* A Hann main lobe is 4 bins wide; compare against bins just outside it */
+#define PROMINENCE_OFFSET 2
+
+static struct peak_picker_cfg cfg = {
+    .min_snr_db     = DEFAULT_MIN_SNR_DB,
+    .full_snr_db    = DEFAULT_FULL_SNR_DB,
+    .min_confidence = DEFAULT_MIN_CONFIDENCE,
+};
+static struct peak_picker_stats stats;
+
+static float32_t floor_mag[PEAK_MAX_BINS];
+static float32_t bin_hz;
+static uint16_t  max_bin;
+
+/* cfg is written from the BT RX thread, read from the DSP thread */
+static struct k_spinlock lock;
+
+void peak_picker_init(uint16_t fft_len, float32_t sample_rate)
+{
+    bin_hz  = sample_rate / (float32_t)fft_len;
+    max_bin = MIN(fft_len / 2, PEAK_MAX_BINS) - 1;
+    memset(floor_mag, 0, sizeof(floor_mag));
+}
+
+void peak_picker_set(const struct peak_picker_cfg *new_cfg)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    cfg = *new_cfg;
+    k_spin_unlock(&lock, key);
+}
+
+void peak_picker_get(struct peak_picker_cfg *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    *out = cfg;
+    k_spin_unlock(&lock, key);
+}
+
+void peak_picker_stats_get(struct peak_picker_stats *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    *out = stats;
+    k_spin_unlock(&lock, key);
+}
+
+static void floor_update(const float32_t *mag, uint16_t lo, uint16_t hi,
+                         int skip_lo, int skip_hi)
+{
+    for (uint16_t i = lo; i <= hi; i++) {
+        if ((int)i >= skip_lo && (int)i <= skip_hi) {
+            continue;
+        }
+        float32_t f = floor_mag[i];
+        if (f == 0.0f) {
+            /* bin just entered the span (first frame or new profile) */
+            f = mag[i];
+        } else if (mag[i] < f) {
+            f += FLOOR_FALL * (mag[i] - f);
+        } else {
+            f += FLOOR_RISE * (mag[i] - f);
+        }
+        floor_mag[i] = MAX(f, FLOOR_MIN);
+    }
+}
+
+static float32_t clamp01(float32_t v)
+{
+    return (v < 0.0f) ? 0.0f : (v > 1.0f) ? 1.0f : v;
+}
+
+bool peak_picker_run(const float32_t *mag, const struct tuning_table *t,
+                     struct peak_result *out)
+{
+    struct peak_picker_cfg c;
+    peak_picker_get(&c);
+
+    uint16_t span_lo = t->span_lo;
+    uint16_t span_hi = MIN(t->span_hi, max_bin);
+
+    /* Strongest bin over all string bands */
+    float32_t best_val = 0.0f;
+    uint16_t  best_idx = 0;
+    for (uint8_t s = 0; s < t->count; s++) {
+        uint16_t lo = t->s[s].lo_bin;
+        uint16_t hi = MIN(t->s[s].hi_bin, span_hi);
+        if (hi < lo) {
+            continue;
+        }
+        float32_t val;
+        uint32_t  idx;
+        arm_max_f32(&mag[lo], hi - lo + 1, &val, &idx);
+        if (val > best_val) {
+            best_val = val;
+            best_idx = lo + idx;
+        }
+    }
+
+    memset(out, 0, sizeof(*out));
+    bool accepted = false;
+
+    if (best_val > 0.0f && best_idx > span_lo && best_idx < span_hi) {
+        float32_t alpha = mag[best_idx - 1];
+        float32_t beta  = best_val;
+        float32_t gamma = mag[best_idx + 1];
+
+        /* Parabolic interpolation */
+        float32_t delta = 0.0f;
+        float32_t denom = alpha - 2.0f * beta + gamma;
+        if (denom != 0.0f) {
+            delta = 0.5f * (alpha - gamma) / denom;
+        }
+
+        out->bin     = best_idx;
+        out->freq_hz = ((float32_t)best_idx + delta) * bin_hz;
+        out->mag     = beta;
+
+        float32_t nf = floor_mag[best_idx];
+        out->snr_db = (nf > 0.0f) ? 20.0f * log10f(beta / nf) : 0.0f;
+
+        /* The band maximum sitting on the skirt of a bigger peak outside
+         * the band is not a note of this profile */
+        if (alpha <= beta && gamma <= beta) {
+            float32_t side = 0.0f;
+            if (best_idx >= span_lo + PROMINENCE_OFFSET) {
+                side = mag[best_idx - PROMINENCE_OFFSET];
+            }
+            if (best_idx + PROMINENCE_OFFSET <= span_hi) {
+                side = MAX(side, mag[best_idx + PROMINENCE_OFFSET]);
+            }
+            float32_t prominence = clamp01(1.0f - side / beta);
+            float32_t snr_range  = MAX(c.full_snr_db - c.min_snr_db, 1.0f);
+            float32_t snr_score  = clamp01((out->snr_db - c.min_snr_db) /
+                                           snr_range);
+            out->confidence = snr_score * (0.5f + 0.5f * prominence);
+        }
+        accepted = out->confidence >= c.min_confidence;
+    }
+
+    if (accepted) {
+        floor_update(mag, span_lo, span_hi, best_idx - PEAK_GUARD_BINS,
+                     best_idx + PEAK_GUARD_BINS);
+    } else {
+        floor_update(mag, span_lo, span_hi, -1, -1);
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    stats.frames++;
+    if (!accepted) {
+        stats.suppressed++;
+    }
+    k_spin_unlock(&lock, key);
+
+    return accepted;
+}
@@ -0,0 +1,53 @@
+#ifndef PEAK_PICKER_H
+#define PEAK_PICKER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "arm_math.h"
+#include "tuning.h"
+
+/* Spectral peak picking over the active tuning profile's bands.
+ *
+ * Each string band is searched with arm_max_f32, the strongest one wins
+ * and is refined by parabolic interpolation. Every bin of the span also
+ * keeps a running noise-floor estimate that falls quickly and rises
+ * slowly, so a steady hum or fan whine becomes floor while a plucked
+ * string stands out from it. The winning peak's SNR against that floor
+ * (and how cleanly it stands above its neighbours) gives a 0..1
+ * confidence; frames below the gate should not reach the LEDs or radio.
+ *
+ * Only the DSP thread may call peak_picker_run().
+ */
+#define PEAK_MAX_BINS 512   /* noise floor storage, i.e. FFT_LEN / 2 */
+
+struct peak_result {
+    uint16_t  bin;          /* integer bin of the maximum */
+    float32_t freq_hz;      /* interpolated, before phase refinement */
+    float32_t mag;
+    float32_t snr_db;       /* against the running floor at that bin */
+    float32_t confidence;   /* 0 = noise .. 1 = clean, strong peak */
+};
+
+struct peak_picker_cfg {
+    float32_t min_snr_db;       /* SNR mapping to confidence 0 */
+    float32_t full_snr_db;      /* SNR mapping to confidence 1 */
+    float32_t min_confidence;   /* gate: below this the frame is dropped */
+};
+
+struct peak_picker_stats {
+    uint32_t frames;
+    uint32_t suppressed;    /* frames that failed the confidence gate */
+};
+
+void peak_picker_init(uint16_t fft_len, float32_t sample_rate);
+
+void peak_picker_set(const struct peak_picker_cfg *cfg);
+void peak_picker_get(struct peak_picker_cfg *cfg);
+void peak_picker_stats_get(struct peak_picker_stats *stats);
+
+/* mag must be valid over t->span_lo..t->span_hi. Fills out and returns
+ * true if the peak passes the confidence gate. */
+bool peak_picker_run(const float32_t *mag, const struct tuning_table *t,
+                     struct peak_result *out);
+
+#endif /* PEAK_PICKER_H */
@@ -0,0 +1,90 @@
+#include "phase_vocoder.h"
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+
+#define TWO_PI (2.0f * PI)
+
+/* One frame of history: band-limited complex bins + hop to its predecessor */
+struct pv_frame {
+    float32_t bins[2 * PV_MAX_BINS];
+    uint32_t  hop;
+};
+
+static struct pv_frame ring[PV_DEPTH];
+static uint8_t   head;          /* index of the newest frame */
+static uint8_t   chain;         /* consecutive frames in ring, 0..PV_DEPTH */
+static uint16_t  band_first;
+static uint16_t  band_bins;
+static float32_t bin_hz;
+static float32_t fs;
+
+static float32_t wrap_phase(float32_t p)
+{
+    return p - TWO_PI * roundf(p / TWO_PI);
+}
+
+int pv_init(uint16_t fft_len, float32_t sample_rate,
+            uint16_t first_bin, uint16_t num_bins)
+{
+    if (num_bins > PV_MAX_BINS || first_bin + num_bins > fft_len / 2) {
+        return -EINVAL;
+    }
+    band_first = first_bin;
+    band_bins  = num_bins;
+    fs         = sample_rate;
+    bin_hz     = sample_rate / (float32_t)fft_len;
+    head       = 0;
+    chain      = 0;
+    return 0;
+}
+
+void pv_push(const float32_t *spectrum, uint32_t hop)
+{
+    head = (head + 1) % PV_DEPTH;
+    memcpy(ring[head].bins, &spectrum[2 * band_first],
+           2 * band_bins * sizeof(float32_t));
+    ring[head].hop = hop;
+
+    if (hop == 0) {
+        chain = 1;
+    } else if (chain < PV_DEPTH) {
+        chain++;
+    }
+}
+
+float32_t pv_refine(uint16_t bin, float32_t coarse_hz)
+{
+    if (bin < band_first || bin >= band_first + band_bins || chain < 2) {
+        return coarse_hz;
+    }
+
+    const float32_t *cur = &ring[head].bins[2 * (bin - band_first)];
+    float32_t f   = coarse_hz;
+    uint32_t  hop = 0;
+    uint8_t   idx = head;
+
+    /* Walk back one frame at a time; each longer baseline is unwrapped
+     * with the estimate from the shorter one before it. */
+    for (uint8_t m = 1; m < chain; m++) {
+        hop += ring[idx].hop;
+        idx  = (idx + PV_DEPTH - 1) % PV_DEPTH;
+
+        const float32_t *old = &ring[idx].bins[2 * (bin - band_first)];
+
+        /* arg(cur * conj(old)) */
+        float32_t re = cur[0] * old[0] + cur[1] * old[1];
+        float32_t im = cur[1] * old[0] - cur[0] * old[1];
+        float32_t dphi     = atan2f(im, re);
+        float32_t expected = TWO_PI * f * (float32_t)hop / fs;
+
+        f += wrap_phase(dphi - expected) * fs / (TWO_PI * (float32_t)hop);
+    }
+
+    /* A jump of more than a bin means the note changed under us */
+    if (fabsf(f - coarse_hz) > bin_hz) {
+        return coarse_hz;
+    }
+    return f;
+}
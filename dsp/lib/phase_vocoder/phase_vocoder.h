@@ -0,0 +1,32 @@
+#ifndef PHASE_VOCODER_H
+#define PHASE_VOCODER_H
+
+#include "arm_math.h"
+
+/* Phase-vocoder frequency refinement.
+ *
+ * Keeps the complex spectrum of the last PV_DEPTH frames for a band of
+ * bins and refines a coarse (parabolic) peak estimate from the phase
+ * advance of that bin between frames. Each extra frame of history
+ * doubles/triples the baseline, so the estimate gets finer without a
+ * longer FFT and without waiting for any new audio.
+ */
+#define PV_DEPTH    3     /* frames of history, including the newest */
+#define PV_MAX_BINS 96    /* bins kept per frame */
+
+/* fft_len/sample_rate describe the analysis; [first_bin, first_bin +
+ * num_bins) is the band kept in history. Returns -EINVAL if it won't fit. */
+int pv_init(uint16_t fft_len, float32_t sample_rate,
+            uint16_t first_bin, uint16_t num_bins);
+
+/* Record the newest frame. spectrum is the interleaved complex output
+ * of arm_cfft_f32; hop is the number of samples between this frame's
+ * start and the previous frame's. hop == 0 breaks the chain (dropped
+ * block, retune, ...) and refinement restarts from this frame. */
+void pv_push(const float32_t *spectrum, uint32_t hop);
+
+/* Refine coarse_hz, measured at peak bin `bin` of the newest frame.
+ * Falls back to coarse_hz when there is no usable history. */
+float32_t pv_refine(uint16_t bin, float32_t coarse_hz);
+
+#endif /* PHASE_VOCODER_H */
@@ -0,0 +1,526 @@
+#include "pitch_log.h"
+#include "bluetooth.h"
+#include "loss_stats.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#define LOG_AREA_ID     FIXED_PARTITION_ID(pitch_log_partition)
+#define LOG_MAGIC       0x50544c47      /* "PTLG" */
+#define LOG_VERSION     2           /* 2: boot count in each record */
+#define LOG_MAX_SECTORS 16
+
+/* ~1.6 s of results at the full frame rate while flash is busy */
+#define LOG_QUEUE_DEPTH 16
+#define LOG_IN_FLIGHT   2
+#define LOG_RETRY_MS    20
+#define LOG_STACK_SIZE  1024
+#define LOG_PRIORITY    12          /* below every results consumer */
+
+/* Outside a recording: spacing of stored results, same note / new note */
+#define LOG_HOLD_MS     CONFIG_APP_PITCH_LOG_HOLD_MS
+#define LOG_MIN_GAP_MS  500
+
+K_MSGQ_DEFINE(log_q, sizeof(struct nus_log_record), LOG_QUEUE_DEPTH, 4);
+K_SEM_DEFINE(log_kick, 0, 1);
+
+static struct fcb fcb;
+static struct flash_sector sectors[LOG_MAX_SECTORS];
+static bool mounted;
+static uint16_t boot_count;
+
+/* Where the last committed upload ended, kept in settings so a reboot
+ * does not send it again. The record's own key tells whether the entry
+ * found there after boot is still that one or its sector was reused. */
+struct log_commit {
+    uint32_t sector_off;
+    uint32_t elem_off;
+    uint32_t t_ms;
+    uint16_t boot;
+};
+static struct log_commit saved_commit;
+static bool have_saved_commit;
+
+/* Last stored result, BLE consumer thread only */
+static bool     have_last;
+static uint32_t last_ms;
+static char     last_note[NUS_NOTE_LEN];
+
+/* Requests from the BT RX thread, taken by the writer thread */
+static struct k_spinlock lock;
+static bool     recording;
+static bool     want_upload;
+static bool     want_commit;
+static bool     want_erase;
+static bool     want_abort;
+static uint16_t credit;
+
+/* Chunks handed to the stack and not yet sent */
+static atomic_t in_flight;
+
+/* Writer thread only. Cursors name the last entry already taken; a
+ * NULL fe_sector means "before the oldest entry". */
+static bool     uploading;
+static bool     upload_done;
+static uint16_t chunk_seq;
+static struct fcb_entry cursor;
+static struct fcb_entry upload_end;     /* cursor after the last chunk */
+static struct fcb_entry start;          /* end of the last commit */
+static uint8_t  chunk[NUS_LOG_CHUNK_MAX];
+static uint16_t chunk_len;              /* built, not yet sent; 0 = none */
+static uint8_t  chunk_records;
+static bool     chunk_last;
+
+static int log_settings_set(const char *name, size_t len,
+                            settings_read_cb read_cb, void *cb_arg)
+{
+    if (settings_name_steq(name, "boot", NULL)) {
+        if (len != sizeof(boot_count) ||
+            read_cb(cb_arg, &boot_count, sizeof(boot_count)) !=
+            sizeof(boot_count)) {
+            return -EINVAL;
+        }
+        return 0;
+    }
+    if (settings_name_steq(name, "commit", NULL)) {
+        if (len != sizeof(saved_commit) ||
+            read_cb(cb_arg, &saved_commit, sizeof(saved_commit)) !=
+            sizeof(saved_commit)) {
+            return -EINVAL;
+        }
+        have_saved_commit = true;
+        return 0;
+    }
+    return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(pitch_log, "pitchlog", NULL,
+                               log_settings_set, NULL, NULL);
+
+/* Count this boot, so records from before a reset stay in order */
+static void count_boot(void)
+{
+    int err = settings_subsys_init();
+    if (!err) {
+        err = settings_load_subtree("pitchlog");
+    }
+    boot_count++;
+    if (!err) {
+        err = settings_save_one("pitchlog/boot", &boot_count,
+                                sizeof(boot_count));
+    }
+    if (err) {
+        printk("LOG: boot count not saved (%d)\n", err);
+    }
+}
+
+static int read_record(const struct fcb_entry *loc,
+                       struct nus_log_record *rec)
+{
+    if (loc->fe_data_len != sizeof(*rec)) {
+        return -EINVAL;
+    }
+    return flash_area_read(fcb.fap, FCB_ENTRY_FA_DATA_OFF(*loc), rec,
+                           sizeof(*rec));
+}
+
+/* Writer thread: remember start across reboots, or that there is none */
+static void save_commit(void)
+{
+    struct nus_log_record rec;
+    int err;
+
+    if (start.fe_sector == NULL || read_record(&start, &rec) != 0) {
+        err = settings_delete("pitchlog/commit");
+    } else {
+        struct log_commit c = {
+            .sector_off = start.fe_sector->fs_off,
+            .elem_off   = start.fe_elem_off,
+            .t_ms       = rec.t_ms,
+            .boot       = rec.boot,
+        };
+        err = settings_save_one("pitchlog/commit", &c, sizeof(c));
+    }
+    if (err) {
+        printk("LOG: commit point not saved (%d)\n", err);
+    }
+}
+
+/* A commit rotates the log up to its last entry's sector, so that entry
+ * is in the oldest sector unless the sector has been erased since */
+static void restore_commit(void)
+{
+    struct fcb_entry loc = { 0 };
+    struct nus_log_record rec;
+
+    if (!have_saved_commit) {
+        return;
+    }
+    while (fcb_getnext(&fcb, &loc) == 0 && loc.fe_sector == fcb.f_oldest) {
+        if (loc.fe_sector->fs_off != saved_commit.sector_off ||
+            loc.fe_elem_off != saved_commit.elem_off) {
+            continue;
+        }
+        if (read_record(&loc, &rec) == 0 && rec.boot == saved_commit.boot &&
+            rec.t_ms == saved_commit.t_ms) {
+            start = loc;
+        }
+        break;
+    }
+}
+
+int pitch_log_init(void)
+{
+    count_boot();
+
+    uint32_t count = ARRAY_SIZE(sectors);
+    int err = flash_area_get_sectors(LOG_AREA_ID, &count, sectors);
+    if (err) {
+        printk("LOG: no flash sectors (%d)\n", err);
+        return err;
+    }
+
+    fcb.f_magic       = LOG_MAGIC;
+    fcb.f_version     = LOG_VERSION;
+    fcb.f_sectors     = sectors;
+    fcb.f_sector_cnt  = (uint8_t)count;
+    fcb.f_scratch_cnt = 0;
+
+    err = fcb_init(LOG_AREA_ID, &fcb);
+    if (err) {
+        /* Not ours or torn: start the log over */
+        const struct flash_area *fa;
+        if (flash_area_open(LOG_AREA_ID, &fa) == 0) {
+            flash_area_erase(fa, 0, fa->fa_size);
+            flash_area_close(fa);
+        }
+        err = fcb_init(LOG_AREA_ID, &fcb);
+    }
+    if (err) {
+        printk("LOG: fcb_init -> %d, log off\n", err);
+        return err;
+    }
+
+    restore_commit();
+    mounted = true;
+    printk("LOG: %u sectors, boot %u, %s%s\n", count, boot_count,
+           fcb_is_empty(&fcb) ? "empty" : "backlog waiting",
+           start.fe_sector ? " after the last commit" : "");
+    return 0;
+}
+
+bool pitch_log_recording(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool on = recording;
+    k_spin_unlock(&lock, key);
+    return on;
+}
+
+/* Outside a recording, store a held note now and then and a new one
+ * no faster than LOG_MIN_GAP_MS */
+static bool thin_out(const struct nus_log_record *r)
+{
+    if (pitch_log_recording()) {
+        return false;
+    }
+    if (have_last) {
+        bool same = memcmp(r->note, last_note, NUS_NOTE_LEN) == 0;
+        if (r->t_ms - last_ms < (same ? LOG_HOLD_MS : LOG_MIN_GAP_MS)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void pitch_log_append(const struct pitch_record *rec)
+{
+    if (!mounted) {
+        return;
+    }
+
+    struct nus_log_record out = {
+        .boot       = boot_count,
+        .t_ms       = k_uptime_get_32(),
+        .freq_hz    = rec->freq_hz,
+        .confidence = (uint8_t)(rec->confidence * 255.0f),
+    };
+    memcpy(out.note, rec->note, NUS_NOTE_LEN);
+
+    if (thin_out(&out)) {
+        loss_stats_inc(CTR_LOG_THINNED);
+        return;
+    }
+    have_last = true;
+    last_ms   = out.t_ms;
+    memcpy(last_note, out.note, NUS_NOTE_LEN);
+
+    if (k_msgq_put(&log_q, &out, K_NO_WAIT) != 0) {
+        loss_stats_inc(CTR_LOG_LOST);
+        return;
+    }
+    k_sem_give(&log_kick);
+}
+
+int pitch_log_command(const struct nus_log_cmd *cmd)
+{
+    if (!mounted) {
+        return -ENODEV;
+    }
+    if (cmd->op > NUS_LOG_OP_ERASE) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    switch (cmd->op) {
+        case NUS_LOG_OP_RECORD:{
+            recording = cmd->arg != 0;
+            break;
+        }
+        case NUS_LOG_OP_UPLOAD:{
+            want_upload = true;
+            credit      = cmd->arg;
+            break;
+        }
+        case NUS_LOG_OP_COMMIT:{
+            want_commit = true;
+            break;
+        }
+        default:{
+            want_erase = true;
+            break;
+        }
+    }
+    k_spin_unlock(&lock, key);
+
+    k_sem_give(&log_kick);
+    return 0;
+}
+
+void pitch_log_credit(uint16_t limit)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    /* A late retry of an older grant must not take credit back */
+    if ((int16_t)(limit - credit) > 0) {
+        credit = limit;
+    }
+    k_spin_unlock(&lock, key);
+    k_sem_give(&log_kick);
+}
+
+void pitch_log_link_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    want_upload = false;
+    want_abort  = true;
+    credit      = 0;
+    k_spin_unlock(&lock, key);
+    k_sem_give(&log_kick);
+}
+
+static void chunk_sent(struct bt_conn *conn, void *user_data)
+{
+    if (atomic_dec(&in_flight) <= 0) {
+        /* Completion for a chunk of a link already reset */
+        atomic_set(&in_flight, 0);
+    }
+    k_sem_give(&log_kick);
+}
+
+/* Full log: erase the oldest sector. Cursors into it move on to the
+ * new oldest entry, which is exactly what followed them. */
+static void drop_oldest(void)
+{
+    struct flash_sector *gone = fcb.f_oldest;
+
+    if (cursor.fe_sector == gone) {
+        memset(&cursor, 0, sizeof(cursor));
+    }
+    if (start.fe_sector == gone) {
+        memset(&start, 0, sizeof(start));
+    }
+    if (upload_end.fe_sector == gone) {
+        upload_done = false;
+    }
+    fcb_rotate(&fcb);
+    loss_stats_inc(CTR_LOG_OVERWRITTEN);
+}
+
+static void store_queued(void)
+{
+    struct nus_log_record rec;
+
+    while (k_msgq_get(&log_q, &rec, K_NO_WAIT) == 0) {
+        struct fcb_entry loc;
+        int err = fcb_append(&fcb, sizeof(rec), &loc);
+        if (err == -ENOSPC) {
+            drop_oldest();
+            err = fcb_append(&fcb, sizeof(rec), &loc);
+        }
+        if (!err) {
+            err = flash_area_write(fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc),
+                                   &rec, sizeof(rec));
+        }
+        if (!err) {
+            err = fcb_append_finish(&fcb, &loc);
+        }
+        loss_stats_inc(err ? CTR_LOG_LOST : CTR_LOG_STORED);
+    }
+}
+
+/* Free everything the finished upload covered. Entries appended since
+ * share its last sector at worst; that sector stays and the next
+ * upload starts after the committed entry. */
+static void commit_upload(void)
+{
+    if (!upload_done) {
+        printk("LOG: nothing to commit\n");
+        return;
+    }
+    upload_done = false;
+    if (upload_end.fe_sector == NULL) {
+        return;
+    }
+
+    struct fcb_entry next = upload_end;
+    if (fcb_getnext(&fcb, &next) != 0) {
+        fcb_clear(&fcb);
+        memset(&start, 0, sizeof(start));
+    } else {
+        while (fcb.f_oldest != upload_end.fe_sector) {
+            fcb_rotate(&fcb);
+        }
+        start = upload_end;
+    }
+    save_commit();
+    printk("LOG: upload committed\n");
+}
+
+static void take_requests(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool reset  = want_abort;
+    bool erase  = want_erase;
+    bool commit = want_commit;
+    bool upload = want_upload;
+    want_abort = want_erase = want_commit = want_upload = false;
+    k_spin_unlock(&lock, key);
+
+    if (reset || erase) {
+        uploading = false;
+        chunk_len = 0;
+        atomic_set(&in_flight, 0);
+    }
+    if (erase) {
+        fcb_clear(&fcb);
+        memset(&start, 0, sizeof(start));
+        upload_done = false;
+        save_commit();
+        printk("LOG: erased\n");
+    }
+    if (commit) {
+        commit_upload();
+    }
+    if (upload) {
+        uploading   = true;
+        upload_done = false;
+        chunk_seq   = 0;
+        chunk_len   = 0;
+        cursor      = start;
+    }
+}
+
+/* Pack as many records after the cursor as the MTU allows */
+static void build_chunk(void)
+{
+    uint16_t room = MIN(nus_max_payload(), sizeof(chunk));
+    struct nus_log_chunk_hdr hdr = {
+        .type = NUS_FRAME_LOG,
+        .seq  = chunk_seq,
+    };
+
+    chunk_len     = sizeof(hdr);
+    chunk_records = 0;
+    chunk_last    = false;
+    while (chunk_len + sizeof(struct nus_log_record) <= room) {
+        struct fcb_entry next = cursor;
+        if (fcb_getnext(&fcb, &next) != 0) {
+            hdr.flags |= NUS_LOG_LAST;
+            chunk_last = true;
+            break;
+        }
+        cursor = next;
+        if (next.fe_data_len != sizeof(struct nus_log_record) ||
+            flash_area_read(fcb.fap, FCB_ENTRY_FA_DATA_OFF(next),
+                            &chunk[chunk_len], next.fe_data_len) != 0) {
+            continue;
+        }
+        chunk_len += sizeof(struct nus_log_record);
+        chunk_records++;
+    }
+    memcpy(chunk, &hdr, sizeof(hdr));
+}
+
+/* Send the next chunk if credit and a stack buffer allow; false to
+ * wait for a completion, a grant or the retry timeout */
+static bool upload_step(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint16_t limit = credit;
+    k_spin_unlock(&lock, key);
+
+    if ((int16_t)(limit - chunk_seq) <= 0 ||
+        atomic_get(&in_flight) >= LOG_IN_FLIGHT) {
+        return false;
+    }
+    if (chunk_len == 0) {
+        build_chunk();
+    }
+
+    atomic_inc(&in_flight);
+    int err = nus_send_cb(chunk, chunk_len, chunk_sent);
+    if (err) {
+        atomic_dec(&in_flight);
+        if (err == -ENOTCONN) {
+            uploading = false;
+            chunk_len = 0;
+            printk("LOG: upload stopped, link down\n");
+        }
+        return false;
+    }
+
+    loss_stats_add(CTR_LOG_UPLOADED, chunk_records);
+    if (chunk_last) {
+        uploading   = false;
+        upload_done = true;
+        upload_end  = cursor;
+        printk("LOG: uploaded in %u chunks\n", chunk_seq + 1);
+    }
+    chunk_seq++;
+    chunk_len = 0;
+    return uploading;
+}
+
+static void writer_entry(void *p1, void *p2, void *p3)
+{
+    while (1) {
+        k_sem_take(&log_kick, uploading ? K_MSEC(LOG_RETRY_MS) : K_FOREVER);
+        if (!mounted) {
+            continue;
+        }
+        store_queued();
+        take_requests();
+        while (uploading && upload_step()) {
+            store_queued();
+        }
+    }
+}
+
+K_THREAD_DEFINE(log_writer, LOG_STACK_SIZE, writer_entry,
+                NULL, NULL, NULL, LOG_PRIORITY, 0, 0);
@@ -0,0 +1,42 @@
+#ifndef PITCH_LOG_H
+#define PITCH_LOG_H
+
+#include <stdint.h>
+#include "nus_proto.h"
+#include "results_bus.h"
+
+/* Store-and-forward pitch log in flash (FCB on pitch_log_partition).
+ *
+ * The BLE consumer hands over every reported result it could not
+ * deliver, and every reported result while recording is on. Outside a
+ * recording they are thinned first: a held note is stored once per
+ * CONFIG_APP_PITCH_LOG_HOLD_MS and note changes at most every 500 ms,
+ * so a peripheral left unconnected does not wear the flash out. A
+ * writer thread below all consumers appends them as nus_log_record
+ * entries, stamped with a boot count kept in settings since uptime
+ * restarts with every boot; when the log is full the oldest sector is
+ * erased to make room.
+ *
+ * The same thread uploads the log on request. It packs records into
+ * MTU-sized NUS_FRAME_LOG chunks and sends them as fast as the link
+ * and the central's credit allow. At most LOG_IN_FLIGHT chunks are
+ * queued in the stack at once, so live pitch frames and acks always
+ * find a buffer. A committed upload frees the sectors it covered; the
+ * log survives reboots until then. Where the commit ended is kept in
+ * settings ("pitchlog/commit") next to the boot count, so after a
+ * reboot the next upload still starts past what was committed.
+ */
+
+/* Mount the log; call once before the consumers run */
+int  pitch_log_init(void);
+
+/* BLE consumer: store a reported result */
+void pitch_log_append(const struct pitch_record *rec);
+bool pitch_log_recording(void);
+
+/* BT RX thread: NUS_CMD_LOG / NUS_CMD_LOG_CREDIT, and link changes */
+int  pitch_log_command(const struct nus_log_cmd *cmd);
+void pitch_log_credit(uint16_t limit);
+void pitch_log_link_reset(void);
+
+#endif /* PITCH_LOG_H */
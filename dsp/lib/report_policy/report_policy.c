@@ -0,0 +1,109 @@
+#include "report_policy.h"
+#include "nus_proto.h"
+
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+
+#define DEFAULT_HYST_CENTS   1.0f
+#define DEFAULT_MIN_INTERVAL 50
+#define DEFAULT_HEARTBEAT    1000
+
+static struct report_policy_cfg cfg = {
+    .hyst_cents      = DEFAULT_HYST_CENTS,
+    .min_interval_ms = DEFAULT_MIN_INTERVAL,
+    .heartbeat_ms    = DEFAULT_HEARTBEAT,
+};
+static struct report_policy_stats stats;
+
+static bool     have_last;
+static float    last_freq;
+static char     last_note[NUS_NOTE_LEN];
+static uint32_t last_ms;
+static bool     pending_heartbeat;  /* why should_send() last said yes */
+
+/* cfg is written from the BT RX thread, read from the DSP thread */
+static struct k_spinlock lock;
+
+void report_policy_set(const struct report_policy_cfg *new_cfg)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    cfg = *new_cfg;
+    k_spin_unlock(&lock, key);
+}
+
+void report_policy_get(struct report_policy_cfg *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    *out = cfg;
+    k_spin_unlock(&lock, key);
+}
+
+void report_policy_stats_get(struct report_policy_stats *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    *out = stats;
+    k_spin_unlock(&lock, key);
+}
+
+void report_policy_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    have_last = false;
+    k_spin_unlock(&lock, key);
+}
+
+bool report_policy_should_send(float freq_hz, const char *note,
+                               uint32_t now_ms)
+{
+    bool send;
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    uint32_t since = now_ms - last_ms;
+
+    pending_heartbeat = false;
+    if (!have_last) {
+        send = true;
+    } else if (cfg.heartbeat_ms &&
+               since >= MAX(cfg.heartbeat_ms, cfg.min_interval_ms)) {
+        send = true;
+        pending_heartbeat = true;
+    } else {
+        bool changed = strncmp(note, last_note, NUS_NOTE_LEN) != 0;
+
+        if (!changed && freq_hz > 0.0f && last_freq > 0.0f) {
+            float cents = 1200.0f * log2f(freq_hz / last_freq);
+            changed = fabsf(cents) >= cfg.hyst_cents;
+        }
+
+        if (!changed) {
+            send = false;
+            stats.suppressed_hyst++;
+        } else if (since < cfg.min_interval_ms) {
+            send = false;
+            stats.suppressed_rate++;
+        } else {
+            send = true;
+        }
+    }
+
+    k_spin_unlock(&lock, key);
+    return send;
+}
+
+void report_policy_sent(float freq_hz, const char *note, uint32_t now_ms)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    if (pending_heartbeat) {
+        stats.sent_heartbeat++;
+    } else {
+        stats.sent_change++;
+    }
+    have_last = true;
+    last_freq = freq_hz;
+    last_ms   = now_ms;
+    strncpy(last_note, note, NUS_NOTE_LEN);
+
+    k_spin_unlock(&lock, key);
+}
@@ -0,0 +1,47 @@
+#ifndef REPORT_POLICY_H
+#define REPORT_POLICY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Decides which pitch results are worth radio time.
+ *
+ * A frame goes out when the note changes or the pitch has moved by at
+ * least hyst_cents since the last frame sent, but never sooner than
+ * min_interval_ms after it. If nothing has gone out for heartbeat_ms
+ * (and min_interval_ms, should that be longer), the next frame is sent
+ * regardless so the central knows we are alive.
+ */
+struct report_policy_cfg {
+    float    hyst_cents;        /* 0 = every frame is a change */
+    uint32_t min_interval_ms;   /* max rate; 0 = unlimited */
+    uint32_t heartbeat_ms;      /* min rate; 0 = no heartbeat */
+};
+
+struct report_policy_stats {
+    uint32_t sent_change;
+    uint32_t sent_heartbeat;
+    uint32_t suppressed_hyst;   /* within hysteresis of the last frame */
+    uint32_t suppressed_rate;   /* changed, but inside min_interval_ms */
+};
+
+void report_policy_set(const struct report_policy_cfg *cfg);
+void report_policy_get(struct report_policy_cfg *cfg);
+void report_policy_stats_get(struct report_policy_stats *stats);
+
+/* Call once per DSP result; true means hand it to the notify path.
+ * Nothing counts as sent until report_policy_sent() says so. */
+bool report_policy_should_send(float freq_hz, const char *note,
+                               uint32_t now_ms);
+
+/* The frame should_send() just passed reached the stack: it becomes
+ * the one later results are compared against. A frame that did not
+ * (link down, no buffer) is simply not reported, so the next result
+ * is offered again. */
+void report_policy_sent(float freq_hz, const char *note, uint32_t now_ms);
+
+/* Forget the last frame sent, e.g. on (re)connect, so the next
+ * result always goes out */
+void report_policy_reset(void);
+
+#endif /* REPORT_POLICY_H */
@@ -0,0 +1,56 @@
+/* lib/results_bus/results_bus.c
+ *
+ * Result and config channels shared by the DSP thread and its consumers.
+ */
+
+#include "results_bus.h"
+#include "loss_stats.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+
+/* Longest a publisher waits for a reader to finish copying */
+#define BUS_TIMEOUT K_MSEC(1)
+
+ZBUS_CHAN_DEFINE(pitch_chan, struct pitch_record, NULL, NULL,
+                 ZBUS_OBSERVERS_EMPTY, ZBUS_MSG_INIT(0));
+
+ZBUS_CHAN_DEFINE(tuner_config_chan, struct tuner_config, NULL, NULL,
+                 ZBUS_OBSERVERS_EMPTY, ZBUS_MSG_INIT(.mode = MODE_READ));
+
+#if defined(CONFIG_ZBUS_MSG_SUBSCRIBER_BUF_ALLOC_STATIC)
+BUILD_ASSERT(sizeof(struct pitch_record) <=
+             CONFIG_ZBUS_MSG_SUBSCRIBER_NET_BUF_STATIC_DATA_SIZE,
+             "pitch_record does not fit a zbus message buffer");
+#endif
+
+int results_publish(struct pitch_record *rec)
+{
+    static uint32_t seq;
+
+    rec->seq = seq++;
+    int err = zbus_chan_pub(&pitch_chan, rec, BUS_TIMEOUT);
+    if (err) {
+        loss_stats_inc(CTR_RESULTS_DROPPED);
+    }
+    return err;
+}
+
+int tuner_config_set(enum bt_mode mode, const char *target_note)
+{
+    struct tuner_config cfg = { .mode = mode };
+
+    strncpy(cfg.target_note, target_note, MAX_NOTE_LEN - 1);
+    return zbus_chan_pub(&tuner_config_chan, &cfg, K_MSEC(100));
+}
+
+int tuner_config_get(struct tuner_config *out)
+{
+    struct tuner_config cfg;
+
+    int err = zbus_chan_read(&tuner_config_chan, &cfg, BUS_TIMEOUT);
+    if (!err) {
+        *out = cfg;
+    }
+    return err;
+}
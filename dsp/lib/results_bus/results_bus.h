@@ -0,0 +1,55 @@
+#ifndef RESULTS_BUS_H
+#define RESULTS_BUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/zbus/zbus.h>
+#include "bluetooth.h"
+#include "nus_proto.h"
+
+/* zbus channels between the DSP thread and everything that uses its
+ * results.
+ *
+ * pitch_chan carries one pitch_record per analysed window. The DSP
+ * thread publishes it once and moves on; the BLE, LED, logging and
+ * stats consumers (src/consumers.c) each take it on their own thread
+ * at their own pace, so none of them can hold up analysis.
+ *
+ * tuner_config_chan holds the tuner mode and target note as a single
+ * message, replacing globals that the BT RX thread used to write while
+ * the DSP thread read them.
+ */
+
+struct pitch_record {
+    uint32_t seq;                   /* per publish, lets consumers spot skips */
+    float    freq_hz;               /* refined pitch, raw peak when gated */
+    float    confidence;
+    float    snr_db;
+    uint32_t t_capture_us;
+    uint32_t t_dsp_end_us;
+    uint16_t dsp_us;
+    int8_t   string_idx;            /* into tuning_active(), -1 if none */
+    uint8_t  detail;                /* NUS_DETAIL_* asked by the central */
+    bool     gated;                 /* below the confidence gate */
+    char     note[NUS_NOTE_LEN + 1];
+};
+
+struct tuner_config {
+    enum bt_mode mode;
+    char         target_note[MAX_NOTE_LEN];
+};
+
+ZBUS_CHAN_DECLARE(pitch_chan, tuner_config_chan);
+
+/* DSP thread: stamp rec->seq and publish. Waits at most for a
+ * consumer's copy to finish, never for its processing; a record that
+ * some consumer had no room for is counted and dropped for it alone. */
+int results_publish(struct pitch_record *rec);
+
+/* BT RX thread: mode and target replace the old ones together */
+int tuner_config_set(enum bt_mode mode, const char *target_note);
+
+/* Any thread: a consistent copy; out is left alone on error */
+int tuner_config_get(struct tuner_config *out);
+
+#endif /* RESULTS_BUS_H */
@@ -0,0 +1,204 @@
+#include "spectral_avg.h"
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+
+#define DEFAULT_MODE     CONFIG_APP_SPECTRAL_AVG_MODE
+#define DEFAULT_FRAMES   4
+#define DEFAULT_ALPHA    0.5f
+#define DEFAULT_OVER_SUB 2.0f
+#define DEFAULT_FLOOR    0.05f
+
+/* Span energy this far above the average (+6 dB) is a new note */
+#define ONSET_RATIO 4.0f
+
+static struct spec_avg_cfg cfg = {
+    .mode     = DEFAULT_MODE,
+    .frames   = DEFAULT_FRAMES,
+    .alpha    = DEFAULT_ALPHA,
+    .over_sub = DEFAULT_OVER_SUB,
+    .floor    = DEFAULT_FLOOR,
+};
+static bool restart = true;
+
+/* cfg/restart are written from the BT RX thread, read from the DSP thread */
+static struct k_spinlock lock;
+
+/* Noise capture requests: frames wanted, or -1 to clear */
+static atomic_t noise_req;
+
+/* DSP thread only */
+static float32_t power[SPEC_AVG_MAX_BINS];
+static float32_t avg[SPEC_AVG_MAX_BINS];
+static float32_t hist[SPEC_AVG_MAX_FRAMES][SPEC_AVG_MAX_BINS];
+static uint8_t   hist_head;
+static uint8_t   hist_fill;
+static uint16_t  avg_lo, avg_hi;
+
+static float32_t noise[SPEC_AVG_MAX_BINS];
+static float32_t noise_acc[SPEC_AVG_MAX_BINS];
+static bool      have_noise;
+static uint8_t   noise_left;
+static uint8_t   noise_frames;
+
+void spectral_avg_init(void)
+{
+    memset(noise, 0, sizeof(noise));
+    have_noise = false;
+    restart    = true;
+    if (CONFIG_APP_NOISE_CAPTURE_FRAMES > 0) {
+        atomic_set(&noise_req, CONFIG_APP_NOISE_CAPTURE_FRAMES);
+    }
+}
+
+int spectral_avg_set(const struct spec_avg_cfg *new_cfg)
+{
+    if (new_cfg->mode > SPEC_AVG_WELCH ||
+        new_cfg->frames < 1 || new_cfg->frames > SPEC_AVG_MAX_FRAMES ||
+        !(new_cfg->alpha > 0.0f && new_cfg->alpha <= 1.0f) ||
+        !(new_cfg->over_sub >= 0.0f) ||
+        !(new_cfg->floor >= 0.0f && new_cfg->floor <= 1.0f)) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (new_cfg->mode != cfg.mode || new_cfg->frames != cfg.frames) {
+        restart = true;
+    }
+    cfg = *new_cfg;
+    k_spin_unlock(&lock, key);
+    return 0;
+}
+
+void spectral_avg_get(struct spec_avg_cfg *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    *out = cfg;
+    k_spin_unlock(&lock, key);
+}
+
+int spectral_avg_noise_capture(uint8_t frames)
+{
+    if (frames == 0) {
+        return -EINVAL;
+    }
+    atomic_set(&noise_req, frames);
+    return 0;
+}
+
+void spectral_avg_noise_clear(void)
+{
+    atomic_set(&noise_req, -1);
+}
+
+static void noise_step(uint16_t lo, uint16_t hi)
+{
+    atomic_val_t req = atomic_set(&noise_req, 0);
+    if (req < 0) {
+        have_noise = false;
+        noise_left = 0;
+        printk("DSP: noise profile cleared\n");
+    } else if (req > 0) {
+        memset(noise_acc, 0, sizeof(noise_acc));
+        noise_left   = (uint8_t)req;
+        noise_frames = (uint8_t)req;
+    }
+    if (noise_left == 0) {
+        return;
+    }
+
+    for (uint16_t i = lo; i <= hi; i++) {
+        noise_acc[i] += power[i];
+    }
+    if (--noise_left == 0) {
+        float32_t inv = 1.0f / (float32_t)noise_frames;
+        for (uint16_t i = 0; i < SPEC_AVG_MAX_BINS; i++) {
+            noise[i] = noise_acc[i] * inv;
+        }
+        have_noise = true;
+        printk("DSP: noise profile from %u frames, bins %u-%u\n",
+               noise_frames, lo, hi);
+    }
+}
+
+void spectral_avg_run(float32_t *mag, uint16_t lo, uint16_t hi)
+{
+    struct spec_avg_cfg c;
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    c = cfg;
+    bool start = restart;
+    restart = false;
+    k_spin_unlock(&lock, key);
+
+    /* Bins past the storage pass through untouched */
+    hi = MIN(hi, SPEC_AVG_MAX_BINS - 1);
+    if (lo > hi) {
+        return;
+    }
+    if (lo != avg_lo || hi != avg_hi) {
+        /* new tuning profile: the old average covers other bins */
+        start  = true;
+        avg_lo = lo;
+        avg_hi = hi;
+    }
+
+    uint16_t  n = hi - lo + 1;
+    float32_t e_new = 0.0f;
+    float32_t e_avg = 0.0f;
+
+    arm_mult_f32(&mag[lo], &mag[lo], &power[lo], n);
+    noise_step(lo, hi);
+    if (c.mode == SPEC_AVG_OFF && !have_noise) {
+        return;
+    }
+
+    arm_mean_f32(&power[lo], n, &e_new);
+    arm_mean_f32(&avg[lo], n, &e_avg);
+    if (start || e_new > ONSET_RATIO * e_avg) {
+        hist_head = 0;
+        hist_fill = 0;
+        start     = true;
+    }
+
+    switch (c.mode) {
+    case SPEC_AVG_EWMA:
+        if (start) {
+            memcpy(&avg[lo], &power[lo], n * sizeof(float32_t));
+        } else {
+            for (uint16_t i = lo; i <= hi; i++) {
+                avg[i] += c.alpha * (power[i] - avg[i]);
+            }
+        }
+        break;
+    case SPEC_AVG_WELCH: {
+        memcpy(&hist[hist_head][lo], &power[lo], n * sizeof(float32_t));
+        hist_head = (hist_head + 1) % c.frames;
+        hist_fill = MIN(hist_fill + 1, c.frames);
+
+        float32_t inv = 1.0f / (float32_t)hist_fill;
+        for (uint16_t i = lo; i <= hi; i++) {
+            float32_t sum = 0.0f;
+            for (uint8_t f = 0; f < hist_fill; f++) {
+                sum += hist[f][i];
+            }
+            avg[i] = sum * inv;
+        }
+        break;
+    }
+    default:
+        memcpy(&avg[lo], &power[lo], n * sizeof(float32_t));
+        break;
+    }
+
+    for (uint16_t i = lo; i <= hi; i++) {
+        float32_t p = avg[i];
+        if (have_noise) {
+            p = MAX(p - c.over_sub * noise[i], c.floor * p);
+        }
+        mag[i] = sqrtf(p);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef SPECTRAL_AVG_H
+#define SPECTRAL_AVG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "arm_math.h"
+#include "nus_proto.h"
+
+/* Spectral averaging and noise subtraction ahead of the peak picker.
+ *
+ * Single-frame magnitudes jump around under fan noise, hum and other
+ * instruments. This stage works on power (|X|^2) over the tuning span:
+ * either an exponentially weighted average or a Welch average of the
+ * last few (overlapping) frames. A burst of energy well above the
+ * average, i.e. a new pluck, restarts the average so the tuner does
+ * not smear the attack into the previous note.
+ *
+ * On command the stage also learns a noise profile: the mean power per
+ * bin over the next few frames, captured while the strings are quiet.
+ * From then on over_sub times that profile is taken off every averaged
+ * bin, never leaving less than floor times the bin's own power.
+ *
+ * Magnitudes are written back in place, so peak_picker_run() and
+ * everything after it are unchanged. Only the DSP thread may call
+ * spectral_avg_run().
+ */
+#define SPEC_AVG_MAX_BINS   160   /* ~2.5 kHz at 16 kHz / 1024, past C7 */
+#define SPEC_AVG_MAX_FRAMES 8
+
+enum spec_avg_mode {
+    SPEC_AVG_OFF   = NUS_SPEC_OFF,
+    SPEC_AVG_EWMA  = NUS_SPEC_EWMA,
+    SPEC_AVG_WELCH = NUS_SPEC_WELCH,
+};
+
+struct spec_avg_cfg {
+    uint8_t   mode;          /* enum spec_avg_mode */
+    uint8_t   frames;        /* Welch: frames averaged, 1..MAX_FRAMES */
+    float32_t alpha;         /* EWMA: weight of the newest frame, (0, 1] */
+    float32_t over_sub;      /* noise profile multiplier, 0 = off */
+    float32_t floor;         /* min fraction of a bin's power kept, 0..1 */
+};
+
+void spectral_avg_init(void);
+
+/* Any thread; a changed mode or Welch length restarts the average */
+int  spectral_avg_set(const struct spec_avg_cfg *cfg);
+void spectral_avg_get(struct spec_avg_cfg *cfg);
+
+/* Any thread: learn the noise profile over the next frames (1..255),
+ * or forget it */
+int  spectral_avg_noise_capture(uint8_t frames);
+void spectral_avg_noise_clear(void);
+
+/* mag valid over lo..hi; averaged and noise-reduced in place */
+void spectral_avg_run(float32_t *mag, uint16_t lo, uint16_t hi);
+
+#endif /* SPECTRAL_AVG_H */
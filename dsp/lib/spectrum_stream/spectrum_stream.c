@@ -0,0 +1,163 @@
+#include "spectrum_stream.h"
+#include "bluetooth.h"
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+
+/* Quantiser steps: 8-bit deltas hold any change on a 0.6 dB grid;
+ * nibbles trade resolution for slew (+-14 dB per frame on 2 dB) */
+#define STEP_DDB_8BIT 6
+#define STEP_DDB_4BIT 20
+
+#define PAYLOAD_MAX (sizeof(struct nus_spec_hdr) + NUS_SPEC_MAX_BINS)
+
+static struct nus_spec_stream_cmd cfg;   /* bits == 0: off */
+static bool restart;
+
+/* cfg/restart are written from the BT RX thread, read from the DSP thread */
+static struct k_spinlock lock;
+
+/* DSP thread only */
+static float32_t power[NUS_SPEC_MAX_BINS];
+static uint8_t   last_q[NUS_SPEC_MAX_BINS];   /* what the receiver holds */
+static uint8_t   payload[PAYLOAD_MAX];
+static uint8_t   seq;
+static uint8_t   since_key;
+static uint8_t   frame_count;
+static struct nus_spec_hdr last_hdr;
+static uint16_t  n_fft_bins;
+
+void spectrum_stream_init(uint16_t fft_len)
+{
+    n_fft_bins = fft_len / 2;
+}
+
+int spectrum_stream_set(const struct nus_spec_stream_cmd *cmd)
+{
+    if ((cmd->bits != 0 && cmd->bits != 4 && cmd->bits != 8) ||
+        cmd->n_bins > NUS_SPEC_MAX_BINS ||
+        cmd->first_bin + cmd->n_bins > n_fft_bins) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    cfg     = *cmd;
+    restart = true;
+    k_spin_unlock(&lock, key);
+    return 0;
+}
+
+void spectrum_stream_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    cfg.bits = 0;
+    restart  = true;
+    k_spin_unlock(&lock, key);
+}
+
+/* Cut payload into chunks; false if the link refused one */
+static bool send_chunks(size_t len, uint8_t flags)
+{
+    uint8_t chunks = DIV_ROUND_UP(len, NUS_SPEC_CHUNK_DATA);
+    uint8_t buf[NUS_MAX_PAYLOAD];
+    struct nus_spec_chunk_hdr hdr = {
+        .type  = NUS_FRAME_SPECTRUM,
+        .seq   = seq,
+        .flags = flags,
+    };
+
+    for (uint8_t c = 0; c < chunks; c++) {
+        size_t off = c * NUS_SPEC_CHUNK_DATA;
+        size_t n   = MIN(len - off, NUS_SPEC_CHUNK_DATA);
+
+        hdr.part = (c << 4) | (chunks - 1);
+        memcpy(buf, &hdr, sizeof(hdr));
+        memcpy(buf + sizeof(hdr), payload + off, n);
+        if (nus_send(buf, sizeof(hdr) + n) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void spectrum_stream_frame(const float32_t *cfft,
+                           const struct tuning_table *tuning)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    struct nus_spec_stream_cmd c = cfg;
+    bool start = restart;
+    restart = false;
+    k_spin_unlock(&lock, key);
+
+    if (c.bits == 0) {
+        return;
+    }
+    if (start) {
+        frame_count = 0;
+    }
+    if (frame_count++ % MAX(c.every, 1) != 0) {
+        return;
+    }
+
+    struct nus_spec_hdr hdr = {
+        .first_bin = c.first_bin,
+        .n_bins    = c.n_bins,
+        .step_ddb  = (c.bits == 8) ? STEP_DDB_8BIT : STEP_DDB_4BIT,
+    };
+    if (hdr.n_bins == 0) {
+        hdr.first_bin = tuning->span_lo;
+        hdr.n_bins    = MIN(tuning->span_hi - tuning->span_lo + 1,
+                            NUS_SPEC_MAX_BINS);
+    }
+
+    bool key_frame = start || since_key >= NUS_SPEC_KEY_INTERVAL ||
+                     memcmp(&hdr, &last_hdr, sizeof(hdr)) != 0;
+
+    /* 10*log10(|X|^2) on the step grid; 0 dB is |X| = 1 */
+    arm_cmplx_mag_squared_f32(&cfft[2 * hdr.first_bin], power, hdr.n_bins);
+    float32_t per_step = 100.0f / hdr.step_ddb;
+
+    memcpy(payload, &hdr, sizeof(hdr));
+    uint8_t *out = payload + sizeof(hdr);
+    size_t len;
+
+    if (key_frame) {
+        for (uint8_t i = 0; i < hdr.n_bins; i++) {
+            float32_t q = (power[i] > 1.0f) ?
+                          log10f(power[i]) * per_step + 0.5f : 0.0f;
+            last_q[i] = (uint8_t)MIN(q, 255.0f);
+            out[i] = last_q[i];
+        }
+        len = sizeof(hdr) + hdr.n_bins;
+    } else {
+        int lim = (c.bits == 8) ? INT8_MAX : 7;
+        memset(out, 0, (hdr.n_bins + 1) / 2);
+        for (uint8_t i = 0; i < hdr.n_bins; i++) {
+            float32_t q = (power[i] > 1.0f) ?
+                          log10f(power[i]) * per_step + 0.5f : 0.0f;
+            int d = (int)MIN(q, 255.0f) - last_q[i];
+            d = CLAMP(d, -lim - 1, lim);
+            last_q[i] += d;
+            if (c.bits == 8) {
+                out[i] = (uint8_t)(int8_t)d;
+            } else {
+                out[i / 2] |= (uint8_t)((d & 0x0F) << ((i & 1) * 4));
+            }
+        }
+        len = sizeof(hdr) + ((c.bits == 8) ? hdr.n_bins :
+                                             (hdr.n_bins + 1) / 2);
+    }
+
+    uint8_t flags = (key_frame ? NUS_SPEC_KEY : 0) |
+                    ((!key_frame && c.bits == 4) ? NUS_SPEC_NIBBLES : 0);
+    if (send_chunks(len, flags)) {
+        since_key = key_frame ? 1 : since_key + 1;
+        last_hdr  = hdr;
+    } else {
+        /* The receiver may have missed part of it: start over */
+        since_key = NUS_SPEC_KEY_INTERVAL;
+    }
+    seq++;
+}
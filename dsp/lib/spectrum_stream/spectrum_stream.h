@@ -0,0 +1,29 @@
+#ifndef SPECTRUM_STREAM_H
+#define SPECTRUM_STREAM_H
+
+#include <stdint.h>
+#include "arm_math.h"
+#include "nus_proto.h"
+#include "tuning.h"
+
+/* Compressed spectrum stream for host-side plots.
+ *
+ * When the central asks for it (NUS_CMD_SPEC_STREAM), every n-th FFT
+ * frame is turned into a band-limited log-magnitude spectrum, delta
+ * coded against the previous one and sent as NUS_FRAME_SPECTRUM chunks
+ * (format in nus_proto.h). Off by default and after every connect.
+ *
+ * Only the DSP thread may call spectrum_stream_frame().
+ */
+
+void spectrum_stream_init(uint16_t fft_len);
+
+/* BT RX thread: start, change or stop the stream */
+int  spectrum_stream_set(const struct nus_spec_stream_cmd *cmd);
+void spectrum_stream_reset(void);
+
+/* DSP thread: cfft is the complex FFT output of this frame */
+void spectrum_stream_frame(const float32_t *cfft,
+                           const struct tuning_table *tuning);
+
+#endif /* SPECTRUM_STREAM_H */
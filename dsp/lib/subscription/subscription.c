@@ -0,0 +1,82 @@
+#include "subscription.h"
+#include "report_policy.h"
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+static uint32_t block_rate;                 /* dHz */
+static uint16_t rate    = NUS_RATE_DEFAULT_DHZ;
+static uint8_t  detail  = NUS_DETAIL_TRACE;
+
+/* The report interval is ours while subscribed; this is the one it
+ * replaced. BT RX thread only. */
+static bool     subscribed;
+static uint32_t own_interval_ms;
+
+/* rate/detail are written from the BT RX thread, read from the DSP thread */
+static struct k_spinlock lock;
+
+void subscription_init(uint32_t block_rate_dhz)
+{
+    block_rate = block_rate_dhz;
+}
+
+int subscription_set(const struct nus_subscribe_cmd *cmd)
+{
+    if (cmd->rate_dhz < NUS_RATE_MIN_DHZ || cmd->rate_dhz > NUS_RATE_MAX_DHZ ||
+        cmd->detail > NUS_DETAIL_TRACE) {
+        return -EINVAL;
+    }
+
+    /* One frame per period at most while the pitch moves. Hysteresis
+     * and heartbeat stay as configured, so a steady pitch still only
+     * goes out once per heartbeat. */
+    struct report_policy_cfg rcfg;
+    report_policy_get(&rcfg);
+    if (!subscribed) {
+        own_interval_ms = rcfg.min_interval_ms;
+        subscribed = true;
+    }
+    rcfg.min_interval_ms = 10000U / cmd->rate_dhz;
+    report_policy_set(&rcfg);
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    rate   = cmd->rate_dhz;
+    detail = cmd->detail;
+    k_spin_unlock(&lock, key);
+
+    printk("BT: subscribe %u.%u frames/s, %s\n", cmd->rate_dhz / 10,
+           cmd->rate_dhz % 10,
+           cmd->detail == NUS_DETAIL_TRACE ? "trace" : "basic");
+    return 0;
+}
+
+void subscription_reset(void)
+{
+    /* Only the interval was the subscription's; a report config set
+     * with NUS_CMD_REPORT_CFG keeps its hysteresis and heartbeat */
+    if (subscribed) {
+        struct report_policy_cfg rcfg;
+        report_policy_get(&rcfg);
+        rcfg.min_interval_ms = own_interval_ms;
+        report_policy_set(&rcfg);
+        subscribed = false;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    rate   = NUS_RATE_DEFAULT_DHZ;
+    detail = NUS_DETAIL_TRACE;
+    k_spin_unlock(&lock, key);
+}
+
+void subscription_plan(bool every_block, struct analysis_plan *plan)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint16_t r = rate;
+    plan->detail = detail;
+    k_spin_unlock(&lock, key);
+
+    plan->windows_per_block = (r > block_rate) ? 2 : 1;
+    plan->block_stride = every_block ? 1 : CLAMP(block_rate / r, 1, UINT8_MAX);
+}
@@ -0,0 +1,39 @@
+#ifndef SUBSCRIPTION_H
+#define SUBSCRIPTION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "nus_proto.h"
+
+/* What the connected central asked for, and how the DSP meets it.
+ *
+ * A subscription is a target pitch-frame rate plus a detail level. The
+ * rate sets the report policy's minimum interval, so frames go out at
+ * most at that cadence while the pitch moves (a steady pitch is still
+ * held back to one per heartbeat), and it sets how much audio
+ * is analysed: below the DMIC block rate only every Nth block is run
+ * through the FFT, above it each block is analysed twice with
+ * overlapping windows. Every new connection starts from the defaults
+ * (NUS_RATE_DEFAULT_DHZ, NUS_DETAIL_TRACE) and gets the report interval
+ * back that the subscription replaced.
+ */
+struct analysis_plan {
+    uint8_t block_stride;       /* analyse every Nth DMIC block */
+    uint8_t windows_per_block;  /* 1, or 2 above the block rate */
+    uint8_t detail;             /* NUS_DETAIL_* */
+};
+
+/* block_rate_dhz: DMIC blocks per second x 10 */
+void subscription_init(uint32_t block_rate_dhz);
+
+/* BT RX thread: validate and apply a central's request */
+int subscription_set(const struct nus_subscribe_cmd *cmd);
+
+/* BT RX thread: back to the defaults, e.g. on (re)connect */
+void subscription_reset(void);
+
+/* DSP thread, once per block. every_block keeps the stride at 1 when
+ * something local (the tuning LEDs) needs every block regardless. */
+void subscription_plan(bool every_block, struct analysis_plan *plan);
+
+#endif /* SUBSCRIPTION_H */
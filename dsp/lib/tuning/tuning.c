@@ -0,0 +1,250 @@
+#include "tuning.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(tuning);
+
+/* Search band around each string: half the gap to its neighbour,
+ * clamped to this many cents either side */
+#define BAND_MAX_CENTS 200.0f
+#define BAND_MIN_CENTS 50.0f
+
+static const char *const pitch_names[12] = {
+    "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"
+};
+
+static const struct tuning_profile standard = {
+    .a4_hz = 440.0f,
+    .count = 6,
+    .midi  = { 40, 45, 50, 55, 59, 64 },      /* E2 A2 D3 G3 B3 E4 */
+};
+
+static struct tuning_table   table;           /* DSP thread only */
+static struct tuning_profile stored = standard;
+static struct tuning_profile pending;
+static atomic_t              pending_flag;
+static struct k_spinlock     lock;
+
+static uint16_t  fft_len;
+static float32_t bin_hz;
+
+static void save_work_handler(struct k_work *work);
+static K_WORK_DEFINE(save_work, save_work_handler);
+
+static float32_t midi_to_hz(uint8_t midi, float32_t a4_hz)
+{
+    return a4_hz * powf(2.0f, ((float32_t)midi - 69.0f) / 12.0f);
+}
+
+static float32_t cents_to_ratio(float32_t cents)
+{
+    return powf(2.0f, cents / 1200.0f);
+}
+
+/* Precompute everything the per-frame path needs */
+static void build_table(const struct tuning_profile *p)
+{
+    table.count   = p->count;
+    table.a4_hz   = p->a4_hz;
+    table.span_lo = fft_len / 2;
+    table.span_hi = 0;
+
+    for (uint8_t i = 0; i < p->count; i++) {
+        struct tuning_string *s = &table.s[i];
+        uint8_t m = p->midi[i];
+
+        snprintf(s->note, sizeof(s->note), "%s%d",
+                 pitch_names[m % 12], (int)(m / 12) - 1);
+        s->freq_hz  = midi_to_hz(m, p->a4_hz);
+        s->inv_freq = 1.0f / s->freq_hz;
+
+        /* Nearest neighbours in pitch, whatever order the strings came in */
+        int gap_lo = 0, gap_hi = 0;
+        for (uint8_t j = 0; j < p->count; j++) {
+            int d = (int)p->midi[j] - (int)m;
+            if (d < 0 && (gap_lo == 0 || -d < gap_lo)) {
+                gap_lo = -d;
+            } else if (d > 0 && (gap_hi == 0 || d < gap_hi)) {
+                gap_hi = d;
+            }
+        }
+        float32_t half_lo = gap_lo ? gap_lo * 50.0f : BAND_MAX_CENTS;
+        float32_t half_hi = gap_hi ? gap_hi * 50.0f : BAND_MAX_CENTS;
+        half_lo = CLAMP(half_lo, BAND_MIN_CENTS, BAND_MAX_CENTS);
+        half_hi = CLAMP(half_hi, BAND_MIN_CENTS, BAND_MAX_CENTS);
+
+        s->own_lo_hz = s->freq_hz / cents_to_ratio(half_lo);
+        s->own_hi_hz = s->freq_hz * cents_to_ratio(half_hi);
+
+        /* Bins are coarse at the bottom end: always keep the centre bin's
+         * neighbours so parabolic interpolation has something to work on */
+        uint16_t centre = (uint16_t)roundf(s->freq_hz / bin_hz);
+        uint16_t lo = (uint16_t)floorf(s->own_lo_hz / bin_hz);
+        uint16_t hi = (uint16_t)ceilf(s->own_hi_hz / bin_hz);
+        s->lo_bin = CLAMP(MIN(lo, centre - 1), 1, fft_len / 2 - 2);
+        s->hi_bin = CLAMP(MAX(hi, centre + 1), 1, fft_len / 2 - 2);
+
+        table.span_lo = MIN(table.span_lo, s->lo_bin - 1);
+        table.span_hi = MAX(table.span_hi, s->hi_bin + 1);
+    }
+
+    LOG_INF("tuning: %u strings, A4=%.1f Hz, bins %u..%u",
+            table.count, (double)table.a4_hz, table.span_lo, table.span_hi);
+}
+
+static bool profile_valid(const struct tuning_profile *p)
+{
+    if (p->count == 0 || p->count > TUNING_MAX_STRINGS) {
+        return false;
+    }
+    if (!(p->a4_hz >= 400.0f && p->a4_hz <= 480.0f)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < p->count; i++) {
+        /* B0 .. C7 covers anything with strings on it */
+        if (p->midi[i] < 23 || p->midi[i] > 96) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ────────────────────────────────────────────────────────────────
+ *  Persistence: tuning/profile
+ * ────────────────────────────────────────────────────────────── */
+static void save_work_handler(struct k_work *work)
+{
+    struct tuning_profile p;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    p = stored;
+    k_spin_unlock(&lock, key);
+
+    int err = settings_save_one("tuning/profile", &p, sizeof(p));
+    if (err) {
+        LOG_ERR("tuning: save failed (%d)", err);
+    }
+}
+
+static int tuning_settings_set(const char *name, size_t len,
+                               settings_read_cb read_cb, void *cb_arg)
+{
+    struct tuning_profile p;
+
+    if (!settings_name_steq(name, "profile", NULL)) {
+        return -ENOENT;
+    }
+    if (len != sizeof(p) || read_cb(cb_arg, &p, sizeof(p)) != sizeof(p)) {
+        return -EINVAL;
+    }
+    if (profile_valid(&p)) {
+        stored = p;
+    }
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(tuning, "tuning", NULL,
+                               tuning_settings_set, NULL, NULL);
+
+/* ────────────────────────────────────────────────────────────────
+ *  API
+ * ────────────────────────────────────────────────────────────── */
+int tuning_init(uint16_t len, float32_t sample_rate)
+{
+    fft_len = len;
+    bin_hz  = sample_rate / (float32_t)len;
+
+    int err = settings_subsys_init();
+    if (!err) {
+        err = settings_load_subtree("tuning");
+    }
+    if (err) {
+        LOG_ERR("tuning: settings unavailable (%d), using standard", err);
+    }
+
+    build_table(&stored);
+    return err;
+}
+
+int tuning_request(const struct tuning_profile *p)
+{
+    if (!profile_valid(p)) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    pending = *p;
+    stored  = *p;
+    k_spin_unlock(&lock, key);
+
+    atomic_set(&pending_flag, 1);
+    k_work_submit(&save_work);
+    return 0;
+}
+
+const struct tuning_table *tuning_active(void)
+{
+    if (atomic_cas(&pending_flag, 1, 0)) {
+        struct tuning_profile p;
+
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        p = pending;
+        k_spin_unlock(&lock, key);
+
+        build_table(&p);
+    }
+    return &table;
+}
+
+int tuning_string_for(const struct tuning_table *t, float32_t freq_hz)
+{
+    for (uint8_t i = 0; i < t->count; i++) {
+        if (freq_hz >= t->s[i].own_lo_hz && freq_hz < t->s[i].own_hi_hz) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int tuning_find(const struct tuning_table *t, const char *note)
+{
+    int first = -1, lowest = -1, highest = -1;
+
+    for (uint8_t i = 0; i < t->count; i++) {
+        const struct tuning_string *s = &t->s[i];
+
+        if (strcmp(s->note, note) == 0) {
+            return i;
+        }
+        /* Letter match: "A" or "EL"/"EH", but not "A" vs "A#2" */
+        if (s->note[0] != note[0] || s->note[1] == '#') {
+            continue;
+        }
+        if (first < 0) {
+            first = i;
+        }
+        if (lowest < 0 || s->freq_hz < t->s[lowest].freq_hz) {
+            lowest = i;
+        }
+        if (highest < 0 || s->freq_hz > t->s[highest].freq_hz) {
+            highest = i;
+        }
+    }
+
+    if (note[0] != '\0' && note[1] == '\0') {
+        return first;
+    }
+    if (note[1] == 'L' && note[2] == '\0') {
+        return lowest;
+    }
+    if (note[1] == 'H' && note[2] == '\0') {
+        return highest;
+    }
+    return -1;
+}
@@ -0,0 +1,62 @@
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "arm_math.h"
+#include "nus_proto.h"
+
+/* Tuning profiles (string count, notes, reference pitch).
+ *
+ * A profile arrives from the central over NUS, is persisted with Zephyr
+ * settings and is turned into a table the DSP thread can use without
+ * any per-frame log2/pow work: each string gets an FFT-bin search band
+ * and a frequency window it owns. The table is only ever touched by
+ * the DSP thread; other threads hand over new profiles with
+ * tuning_request() and the DSP thread picks them up between frames.
+ */
+#define TUNING_MAX_STRINGS NUS_PROFILE_MAX_STRINGS
+#define TUNING_NOTE_LEN    4      /* "F#3" + NUL */
+
+struct tuning_profile {
+    float32_t a4_hz;
+    uint8_t   count;
+    uint8_t   midi[TUNING_MAX_STRINGS];   /* MIDI note per string */
+};
+
+struct tuning_string {
+    char      note[TUNING_NOTE_LEN];
+    float32_t freq_hz;
+    float32_t inv_freq;        /* cents = 1200 * log2(f * inv_freq) */
+    float32_t own_lo_hz;       /* [own_lo_hz, own_hi_hz) maps to this string */
+    float32_t own_hi_hz;
+    uint16_t  lo_bin;          /* inclusive peak-search band */
+    uint16_t  hi_bin;
+};
+
+struct tuning_table {
+    uint8_t   count;
+    float32_t a4_hz;
+    uint16_t  span_lo;         /* union of all bands, +-1 bin for interpolation */
+    uint16_t  span_hi;
+    struct tuning_string s[TUNING_MAX_STRINGS];
+};
+
+/* Load the persisted profile (standard EADGBE @ 440 Hz if none) and
+ * build the table for this FFT setup. Call before the DSP thread runs. */
+int tuning_init(uint16_t fft_len, float32_t sample_rate);
+
+/* Any thread: validate, queue for the DSP thread and persist */
+int tuning_request(const struct tuning_profile *profile);
+
+/* DSP thread: apply a pending profile if any, return the active table */
+const struct tuning_table *tuning_active(void);
+
+/* String owning freq_hz, or -1 if it falls between/outside all strings */
+int tuning_string_for(const struct tuning_table *t, float32_t freq_hz);
+
+/* String named by a tune command: exact "D3", a bare letter ("A" = first
+ * A string) or the shell's legacy EL/EH (lowest/highest E). -1 if none. */
+int tuning_find(const struct tuning_table *t, const char *note);
+
+#endif /* TUNING_H */
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Decode the DSP node's binary RTT log (CONFIG_APP_BINLOG).
+
+Capture RTT up-buffer 1 with e.g.
+
+    JLinkRTTLogger -Device NRF52832_XXAA -If SWD -Speed 4000 -RTTChannel 1 binlog.bin
+
+then run
+
+    scripts/binlog_decode.py binlog.bin            # or '-' for stdin
+
+The dictionary (event ids and format strings) is read from
+lib/binlog/binlog.h, so the decoder never drifts from the firmware.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_HEADER = os.path.join(HERE, "..", "lib", "binlog", "binlog.h")
+
+MAGIC = 0xB1
+RECORD = struct.Struct("<BBHIII")      # magic, id, seq, cycles, arg0, arg1
+CONV = re.compile(r"%[-+ #0]*\d*(?:\.\d+)?([diufsx])")
+
+
+def load_dictionary(path):
+    """Return [(name, fmt), ...] in enum order from BINLOG_EVENTS(X)."""
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    events = re.findall(r'X\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', text)
+    if not events:
+        sys.exit(f"no BINLOG_EVENTS found in {path}")
+    return events
+
+
+def render(fmt, args):
+    """Apply fmt to the raw 32-bit args according to each conversion."""
+    values = []
+    for conv, raw in zip(CONV.findall(fmt), args):
+        if conv == "f":
+            values.append(struct.unpack("<f", struct.pack("<I", raw))[0])
+        elif conv == "s":
+            values.append(struct.pack("<I", raw).split(b"\0")[0]
+                          .decode("utf-8", "replace"))
+        elif conv in "di":
+            values.append(struct.unpack("<i", struct.pack("<I", raw))[0])
+        else:
+            values.append(raw)
+    try:
+        return fmt % tuple(values)
+    except TypeError:
+        return f"{fmt} {args}"
+
+
+def records(data):
+    """Yield unpacked records, resyncing on the magic byte after garbage."""
+    i = 0
+    while i + RECORD.size <= len(data):
+        if data[i] != MAGIC:
+            i += 1
+            continue
+        yield RECORD.unpack_from(data, i)
+        i += RECORD.size
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("capture", help="raw RTT channel 1 capture, '-' for stdin")
+    ap.add_argument("--header", default=DEFAULT_HEADER,
+                    help="binlog.h holding the dictionary")
+    ap.add_argument("--cycle-hz", type=float, default=32768.0,
+                    help="k_cycle_get_32() rate (nRF52 RTC: 32768)")
+    args = ap.parse_args()
+
+    events = load_dictionary(args.header)
+    if args.capture == "-":
+        data = sys.stdin.buffer.read()
+    else:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+
+    first = None
+    expect = None
+    lost = 0
+    for _, ev, seq, cycles, a0, a1 in records(data):
+        if expect is not None and seq != expect:
+            gap = (seq - expect) & 0xFFFF
+            lost += gap
+            print(f"--- {gap} record(s) lost ---")
+        expect = (seq + 1) & 0xFFFF
+
+        if first is None:
+            first = cycles
+        t = ((cycles - first) & 0xFFFFFFFF) / args.cycle_hz
+
+        if ev < len(events):
+            name, fmt = events[ev]
+            print(f"[{t:10.4f}] {render(fmt, (a0, a1))}")
+        else:
+            print(f"[{t:10.4f}] <unknown id {ev}> {a0:#010x} {a1:#010x}")
+
+    if lost:
+        print(f"{lost} record(s) lost in total", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,296 @@
+/* src/consumers.c
+ *
+ * Threads that act on the DSP thread's results (lib/results_bus): BLE
+ * reporting, the tuning LEDs, console logging and timing stats. All run
+ * below PROC_PRIORITY so analysis never waits for them.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/zbus/zbus.h>
+#include "bluetooth.h"
+#include "nus_proto.h"
+#include "results_bus.h"
+#include "report_policy.h"
+#include "led.h"
+#include "tuning.h"
+#include "loss_stats.h"
+#if defined(CONFIG_APP_BINLOG)
+#include "binlog.h"
+#endif
+#if defined(CONFIG_APP_PITCH_LOG)
+#include "pitch_log.h"
+#endif
+#if defined(CONFIG_APP_FRAME_CYCLES)
+#include <zephyr/timing/timing.h>
+#endif
+
+#define BLE_STACK_SIZE   1024
+#define BLE_PRIORITY     8
+#define LED_STACK_SIZE   768
+#define LED_PRIORITY     9
+#define LOG_STACK_SIZE   1024
+#define LOG_PRIORITY     10
+#define STATS_STACK_SIZE 768
+#define STATS_PRIORITY   11
+
+/* Seconds between timing summaries */
+#define STATS_PERIOD_S   10
+/* Results per log cost report (CONFIG_APP_FRAME_CYCLES) */
+#define LOG_COST_WINDOW  64
+
+/* BLE and stats need every record; LED and log only the latest */
+ZBUS_MSG_SUBSCRIBER_DEFINE(ble_result_sub);
+ZBUS_MSG_SUBSCRIBER_DEFINE(stats_result_sub);
+ZBUS_SUBSCRIBER_DEFINE(led_result_sub, 4);
+ZBUS_SUBSCRIBER_DEFINE(log_result_sub, 4);
+
+ZBUS_CHAN_ADD_OBS(pitch_chan, ble_result_sub, 0);
+ZBUS_CHAN_ADD_OBS(pitch_chan, led_result_sub, 1);
+ZBUS_CHAN_ADD_OBS(pitch_chan, log_result_sub, 2);
+ZBUS_CHAN_ADD_OBS(pitch_chan, stats_result_sub, 3);
+
+/* --- BLE ---------------------------------------------------------- */
+
+/* Sequence numbers count frames offered while a central is subscribed,
+ * so every gap the central sees is a frame lost on the way. Both frame
+ * types share the sequence space. Returns false if the frame did not
+ * reach the stack. */
+static bool send_pitch_frame(const struct pitch_record *rec)
+{
+    static uint16_t seq;
+    int err;
+
+    if (rec->detail == NUS_DETAIL_TRACE) {
+        struct nus_pitch_frame out = {
+            .type         = NUS_FRAME_PITCH,
+            .freq_hz      = rec->freq_hz,
+            .seq          = seq,
+            .t_capture_us = rec->t_capture_us,
+            .t_dsp_end_us = rec->t_dsp_end_us,
+            .dsp_us       = rec->dsp_us,
+        };
+        memcpy(out.note, rec->note, NUS_NOTE_LEN);
+        err = nus_send(&out, sizeof(out));
+    } else {
+        struct nus_pitch_lite_frame out = {
+            .type       = NUS_FRAME_PITCH_LITE,
+            .freq_hz    = rec->freq_hz,
+            .seq        = seq,
+            .confidence = (uint8_t)(rec->confidence * 255.0f),
+            .snr_db     = (int8_t)CLAMP(rec->snr_db, INT8_MIN, INT8_MAX),
+        };
+        memcpy(out.note, rec->note, NUS_NOTE_LEN);
+        err = nus_send(&out, sizeof(out));
+    }
+    if (err == -ENOTCONN) {
+        loss_stats_inc(CTR_NOTIFY_NOT_READY);
+        return false;
+    }
+    seq++;
+    loss_stats_inc(CTR_FRAMES_OFFERED);
+    if (err) {
+        loss_stats_inc(CTR_NOTIFY_ERRORS);
+    }
+    return err == 0;
+}
+
+static void ble_consumer_entry(void *p1, void *p2, void *p3)
+{
+    const struct zbus_channel *chan;
+    struct pitch_record rec;
+
+    while (zbus_sub_wait_msg(&ble_result_sub, &chan, &rec, K_FOREVER) == 0) {
+        if (rec.gated) {
+            /* Noise, hum or between notes: no airtime spent on it */
+            continue;
+        }
+        uint32_t now_ms = k_uptime_get_32();
+        if (!report_policy_should_send(rec.freq_hz, rec.note, now_ms)) {
+            loss_stats_inc(CTR_FRAMES_HELD);
+            continue;
+        }
+        bool sent = send_pitch_frame(&rec);
+        if (sent) {
+            report_policy_sent(rec.freq_hz, rec.note, now_ms);
+        }
+#if defined(CONFIG_APP_PITCH_LOG)
+        /* Keep what the central missed, or everything while recording */
+        if (!sent || pitch_log_recording()) {
+            pitch_log_append(&rec);
+        }
+#endif
+    }
+}
+
+/* --- LEDs --------------------------------------------------------- */
+
+static void led_consumer_entry(void *p1, void *p2, void *p3)
+{
+    const struct zbus_channel *chan;
+    struct pitch_record rec;
+    struct tuner_config cfg = { .mode = MODE_READ };
+
+    while (zbus_sub_wait(&led_result_sub, &chan, K_FOREVER) == 0) {
+        if (zbus_chan_read(chan, &rec, K_MSEC(10)) != 0 || rec.gated) {
+            /* Leave the LEDs as they are between notes */
+            continue;
+        }
+        tuner_config_get(&cfg);
+
+        if (cfg.mode == MODE_TUNE) {
+            const struct tuning_table *tuning = tuning_active();
+            int target = tuning_find(tuning, cfg.target_note);
+            if (target >= 0) {
+                led_show_cents(1200.0f * log2f(rec.freq_hz *
+                                               tuning->s[target].inv_freq));
+            } else {
+                led_set_rgb(255, 0, 0);
+            }
+        } else {
+            led_set_rgb(0, 0, 255);
+        }
+    }
+}
+
+/* --- Logging ------------------------------------------------------ */
+
+/* Per-frame diagnostics: packed records with CONFIG_APP_BINLOG, text otherwise */
+static inline void log_peak(float freq, const char *note)
+{
+#if defined(CONFIG_APP_BINLOG)
+    binlog_put(BL_FFT_PEAK, binlog_f32(freq), 0);
+    binlog_put(BL_PEAK_NOTE, binlog_f32(freq), binlog_str(note));
+#else
+    printk("FFT peak: %.1f Hz\n", (double)freq);
+    printk("Peak %.1f Hz and Note: %s\n", (double)freq, note);
+#endif
+}
+
+static inline void log_low_confidence(const struct pitch_record *rec)
+{
+#if defined(CONFIG_APP_BINLOG)
+    binlog_put(BL_LOW_CONF, binlog_f32(rec->freq_hz), binlog_f32(rec->snr_db));
+#else
+    printk("Low confidence: %.1f Hz, SNR %.1f dB\n",
+           (double)rec->freq_hz, (double)rec->snr_db);
+#endif
+}
+
+static inline void log_detected(const char *note)
+{
+#if defined(CONFIG_APP_BINLOG)
+    binlog_put(BL_DETECTED, binlog_str(note), 0);
+#else
+    printk("Detected note: %s\n", note);
+#endif
+}
+
+static void log_result(const struct pitch_record *rec)
+{
+    struct tuner_config cfg;
+
+    if (rec->gated) {
+        log_low_confidence(rec);
+        return;
+    }
+    log_peak(rec->freq_hz, rec->note);
+    tuner_config_get(&cfg);
+    if (cfg.mode != MODE_TUNE) {
+        log_detected(rec->note);
+    }
+}
+
+/* What one result's logging costs this thread, printk against binlog:
+ * build with and without CONFIG_APP_BINLOG to compare */
+#if defined(CONFIG_APP_FRAME_CYCLES)
+static void log_cost_add(timing_t t0)
+{
+    static uint64_t sum;
+    static uint32_t n;
+
+    timing_t t1 = timing_counter_get();
+    sum += timing_cycles_get(&t0, &t1);
+    if (++n < LOG_COST_WINDOW) {
+        return;
+    }
+#if defined(CONFIG_APP_BINLOG)
+    binlog_put(BL_LOG_COST, (uint32_t)(sum / n), 0);
+#else
+    printk("Log cost: %u cycles/result\n", (uint32_t)(sum / n));
+#endif
+    sum = 0;
+    n = 0;
+}
+#endif
+
+static void log_consumer_entry(void *p1, void *p2, void *p3)
+{
+    const struct zbus_channel *chan;
+    struct pitch_record rec;
+    uint32_t next_seq = 0;
+
+    while (zbus_sub_wait(&log_result_sub, &chan, K_FOREVER) == 0) {
+        if (zbus_chan_read(chan, &rec, K_MSEC(10)) != 0) {
+            continue;
+        }
+        /* Woken twice for one record after falling behind */
+        if ((int32_t)(rec.seq - next_seq) < 0) {
+            continue;
+        }
+        for (uint32_t i = next_seq; i != rec.seq; i++) {
+            loss_stats_inc(CTR_RESULTS_UNLOGGED);
+        }
+        next_seq = rec.seq + 1;
+
+#if defined(CONFIG_APP_FRAME_CYCLES)
+        timing_t t0 = timing_counter_get();
+        log_result(&rec);
+        log_cost_add(t0);
+#else
+        log_result(&rec);
+#endif
+    }
+}
+
+/* --- Stats -------------------------------------------------------- */
+
+static void stats_consumer_entry(void *p1, void *p2, void *p3)
+{
+    const struct zbus_channel *chan;
+    struct pitch_record rec;
+    uint32_t n = 0, gated = 0, dsp_sum = 0, dsp_max = 0;
+    int64_t  next = k_uptime_get() + STATS_PERIOD_S * MSEC_PER_SEC;
+
+    while (1) {
+        int err = zbus_sub_wait_msg(&stats_result_sub, &chan, &rec,
+                                    K_TIMEOUT_ABS_MS(next));
+        if (err == 0) {
+            n++;
+            gated   += rec.gated;
+            dsp_sum += rec.dsp_us;
+            dsp_max  = MAX(dsp_max, rec.dsp_us);
+        }
+        if (k_uptime_get() < next) {
+            continue;
+        }
+        next += STATS_PERIOD_S * MSEC_PER_SEC;
+        if (n == 0) {
+            continue;
+        }
+        printk("DSP: %u results in %u s, %u gated, window %u us avg %u max\n",
+               n, STATS_PERIOD_S, gated, dsp_sum / n, dsp_max);
+        n = gated = dsp_sum = dsp_max = 0;
+    }
+}
+
+K_THREAD_DEFINE(ble_consumer, BLE_STACK_SIZE, ble_consumer_entry,
+                NULL, NULL, NULL, BLE_PRIORITY, 0, 0);
+K_THREAD_DEFINE(led_consumer, LED_STACK_SIZE, led_consumer_entry,
+                NULL, NULL, NULL, LED_PRIORITY, 0, 0);
+K_THREAD_DEFINE(log_consumer, LOG_STACK_SIZE, log_consumer_entry,
+                NULL, NULL, NULL, LOG_PRIORITY, 0, 0);
+K_THREAD_DEFINE(stats_consumer, STATS_STACK_SIZE, stats_consumer_entry,
+                NULL, NULL, NULL, STATS_PRIORITY, 0, 0);
@@ -0,0 +1,145 @@
+#ifndef HANN_H
+#define HANN_H
+
+#include "arm_math.h"
+
+/* Periodic Hann window for the 1024-point analysis FFT,
+ * hann[n] = 0.5 * (1 - cos(2 * pi * n / 1024)).
+ *
+ * Shared by the DSP thread (src/main.c) and the kernel benchmarks in
+ * bench/, so both always window with the same table.
+ */
+#define HANN_LEN 1024
+
+static const float32_t hann[HANN_LEN] = {
+    0.00000000e+00f, 9.41235870e-06f, 3.76490804e-05f, 8.47091021e-05f, 1.50590652e-04f, 2.35291249e-04f, 3.38807706e-04f, 4.61136124e-04f,
+    6.02271897e-04f, 7.62209713e-04f, 9.40943550e-04f, 1.13846668e-03f, 1.35477166e-03f, 1.58985035e-03f, 1.84369391e-03f, 2.11629277e-03f,
+    2.40763666e-03f, 2.71771463e-03f, 3.04651500e-03f, 3.39402538e-03f, 3.76023270e-03f, 4.14512317e-03f, 4.54868229e-03f, 4.97089487e-03f,
+    5.41174502e-03f, 5.87121613e-03f, 6.34929092e-03f, 6.84595138e-03f, 7.36117881e-03f, 7.89495381e-03f, 8.44725628e-03f, 9.01806545e-03f,
+    9.60735980e-03f, 1.02151172e-02f, 1.08413146e-02f, 1.14859287e-02f, 1.21489350e-02f, 1.28303086e-02f, 1.35300239e-02f, 1.42480545e-02f,
+    1.49843734e-02f, 1.57389529e-02f, 1.65117645e-02f, 1.73027792e-02f, 1.81119671e-02f, 1.89392979e-02f, 1.97847403e-02f, 2.06482626e-02f,
+    2.15298321e-02f, 2.24294158e-02f, 2.33469798e-02f, 2.42824895e-02f, 2.52359097e-02f, 2.62072045e-02f, 2.71963373e-02f, 2.82032709e-02f,
+    2.92279674e-02f, 3.02703882e-02f, 3.13304940e-02f, 3.24082450e-02f, 3.35036006e-02f, 3.46165195e-02f, 3.57469598e-02f, 3.68948789e-02f,
+    3.80602337e-02f, 3.92429803e-02f, 4.04430742e-02f, 4.16604700e-02f, 4.28951221e-02f, 4.41469840e-02f, 4.54160085e-02f, 4.67021477e-02f,
+    4.80053534e-02f, 4.93255765e-02f, 5.06627672e-02f, 5.20168751e-02f, 5.33878494e-02f, 5.47756384e-02f, 5.61801898e-02f, 5.76014508e-02f,
+    5.90393678e-02f, 6.04938868e-02f, 6.19649529e-02f, 6.34525108e-02f, 6.49565044e-02f, 6.64768772e-02f, 6.80135719e-02f, 6.95665307e-02f,
+    7.11356950e-02f, 7.27210058e-02f, 7.43224034e-02f, 7.59398276e-02f, 7.75732174e-02f, 7.92225113e-02f, 8.08876472e-02f, 8.25685625e-02f,
+    8.42651938e-02f, 8.59774774e-02f, 8.77053486e-02f, 8.94487425e-02f, 9.12075934e-02f, 9.29818351e-02f, 9.47714009e-02f, 9.65762232e-02f,
+    9.83962343e-02f, 1.00231365e-01f, 1.02081548e-01f, 1.03946711e-01f, 1.05826786e-01f, 1.07721701e-01f, 1.09631386e-01f, 1.11555767e-01f,
+    1.13494773e-01f, 1.15448331e-01f, 1.17416367e-01f, 1.19398807e-01f, 1.21395577e-01f, 1.23406600e-01f, 1.25431803e-01f, 1.27471107e-01f,
+    1.29524437e-01f, 1.31591716e-01f, 1.33672864e-01f, 1.35767805e-01f, 1.37876459e-01f, 1.39998746e-01f, 1.42134587e-01f, 1.44283902e-01f,
+    1.46446609e-01f, 1.48622628e-01f, 1.50811875e-01f, 1.53014270e-01f, 1.55229728e-01f, 1.57458166e-01f, 1.59699501e-01f, 1.61953648e-01f,
+    1.64220523e-01f, 1.66500039e-01f, 1.68792111e-01f, 1.71096653e-01f, 1.73413579e-01f, 1.75742799e-01f, 1.78084229e-01f, 1.80437778e-01f,
+    1.82803358e-01f, 1.85180881e-01f, 1.87570256e-01f, 1.89971394e-01f, 1.92384205e-01f, 1.94808597e-01f, 1.97244479e-01f, 1.99691760e-01f,
+    2.02150348e-01f, 2.04620149e-01f, 2.07101071e-01f, 2.09593021e-01f, 2.12095904e-01f, 2.14609627e-01f, 2.17134095e-01f, 2.19669212e-01f,
+    2.22214883e-01f, 2.24771014e-01f, 2.27337506e-01f, 2.29914264e-01f, 2.32501190e-01f, 2.35098188e-01f, 2.37705159e-01f, 2.40322005e-01f,
+    2.42948628e-01f, 2.45584929e-01f, 2.48230808e-01f, 2.50886167e-01f, 2.53550904e-01f, 2.56224920e-01f, 2.58908114e-01f, 2.61600385e-01f,
+    2.64301632e-01f, 2.67011752e-01f, 2.69730645e-01f, 2.72458206e-01f, 2.75194335e-01f, 2.77938928e-01f, 2.80691881e-01f, 2.83453091e-01f,
+    2.86222453e-01f, 2.88999865e-01f, 2.91785220e-01f, 2.94578414e-01f, 2.97379343e-01f, 3.00187900e-01f, 3.03003980e-01f, 3.05827477e-01f,
+    3.08658284e-01f, 3.11496295e-01f, 3.14341403e-01f, 3.17193501e-01f, 3.20052482e-01f, 3.22918237e-01f, 3.25790660e-01f, 3.28669641e-01f,
+    3.31555073e-01f, 3.34446847e-01f, 3.37344854e-01f, 3.40248985e-01f, 3.43159130e-01f, 3.46075180e-01f, 3.48997025e-01f, 3.51924556e-01f,
+    3.54857661e-01f, 3.57796231e-01f, 3.60740155e-01f, 3.63689322e-01f, 3.66643621e-01f, 3.69602941e-01f, 3.72567170e-01f, 3.75536197e-01f,
+    3.78509910e-01f, 3.81488197e-01f, 3.84470946e-01f, 3.87458044e-01f, 3.90449380e-01f, 3.93444840e-01f, 3.96444312e-01f, 3.99447683e-01f,
+    4.02454839e-01f, 4.05465668e-01f, 4.08480056e-01f, 4.11497890e-01f, 4.14519056e-01f, 4.17543440e-01f, 4.20570928e-01f, 4.23601407e-01f,
+    4.26634763e-01f, 4.29670880e-01f, 4.32709646e-01f, 4.35750945e-01f, 4.38794662e-01f, 4.41840685e-01f, 4.44888896e-01f, 4.47939183e-01f,
+    4.50991430e-01f, 4.54045522e-01f, 4.57101344e-01f, 4.60158781e-01f, 4.63217718e-01f, 4.66278040e-01f, 4.69339632e-01f, 4.72402378e-01f,
+    4.75466163e-01f, 4.78530872e-01f, 4.81596389e-01f, 4.84662598e-01f, 4.87729386e-01f, 4.90796635e-01f, 4.93864231e-01f, 4.96932058e-01f,
+    5.00000000e-01f, 5.03067942e-01f, 5.06135769e-01f, 5.09203365e-01f, 5.12270614e-01f, 5.15337402e-01f, 5.18403611e-01f, 5.21469128e-01f,
+    5.24533837e-01f, 5.27597622e-01f, 5.30660368e-01f, 5.33721960e-01f, 5.36782282e-01f, 5.39841219e-01f, 5.42898656e-01f, 5.45954478e-01f,
+    5.49008570e-01f, 5.52060817e-01f, 5.55111104e-01f, 5.58159315e-01f, 5.61205338e-01f, 5.64249055e-01f, 5.67290354e-01f, 5.70329120e-01f,
+    5.73365237e-01f, 5.76398593e-01f, 5.79429072e-01f, 5.82456560e-01f, 5.85480944e-01f, 5.88502110e-01f, 5.91519944e-01f, 5.94534332e-01f,
+    5.97545161e-01f, 6.00552317e-01f, 6.03555688e-01f, 6.06555160e-01f, 6.09550620e-01f, 6.12541956e-01f, 6.15529054e-01f, 6.18511803e-01f,
+    6.21490090e-01f, 6.24463803e-01f, 6.27432830e-01f, 6.30397059e-01f, 6.33356379e-01f, 6.36310678e-01f, 6.39259845e-01f, 6.42203769e-01f,
+    6.45142339e-01f, 6.48075444e-01f, 6.51002975e-01f, 6.53924820e-01f, 6.56840870e-01f, 6.59751015e-01f, 6.62655146e-01f, 6.65553153e-01f,
+    6.68444927e-01f, 6.71330359e-01f, 6.74209340e-01f, 6.77081763e-01f, 6.79947518e-01f, 6.82806499e-01f, 6.85658597e-01f, 6.88503705e-01f,
+    6.91341716e-01f, 6.94172523e-01f, 6.96996020e-01f, 6.99812100e-01f, 7.02620657e-01f, 7.05421586e-01f, 7.08214780e-01f, 7.11000135e-01f,
+    7.13777547e-01f, 7.16546909e-01f, 7.19308119e-01f, 7.22061072e-01f, 7.24805665e-01f, 7.27541794e-01f, 7.30269355e-01f, 7.32988248e-01f,
+    7.35698368e-01f, 7.38399615e-01f, 7.41091886e-01f, 7.43775080e-01f, 7.46449096e-01f, 7.49113833e-01f, 7.51769192e-01f, 7.54415071e-01f,
+    7.57051372e-01f, 7.59677995e-01f, 7.62294841e-01f, 7.64901812e-01f, 7.67498810e-01f, 7.70085736e-01f, 7.72662494e-01f, 7.75228986e-01f,
+    7.77785117e-01f, 7.80330788e-01f, 7.82865905e-01f, 7.85390373e-01f, 7.87904096e-01f, 7.90406979e-01f, 7.92898929e-01f, 7.95379851e-01f,
+    7.97849652e-01f, 8.00308240e-01f, 8.02755521e-01f, 8.05191403e-01f, 8.07615795e-01f, 8.10028606e-01f, 8.12429744e-01f, 8.14819119e-01f,
+    8.17196642e-01f, 8.19562222e-01f, 8.21915771e-01f, 8.24257201e-01f, 8.26586421e-01f, 8.28903347e-01f, 8.31207889e-01f, 8.33499961e-01f,
+    8.35779477e-01f, 8.38046352e-01f, 8.40300499e-01f, 8.42541834e-01f, 8.44770272e-01f, 8.46985730e-01f, 8.49188125e-01f, 8.51377372e-01f,
+    8.53553391e-01f, 8.55716098e-01f, 8.57865413e-01f, 8.60001254e-01f, 8.62123541e-01f, 8.64232195e-01f, 8.66327136e-01f, 8.68408284e-01f,
+    8.70475563e-01f, 8.72528893e-01f, 8.74568197e-01f, 8.76593400e-01f, 8.78604423e-01f, 8.80601193e-01f, 8.82583633e-01f, 8.84551669e-01f,
+    8.86505227e-01f, 8.88444233e-01f, 8.90368614e-01f, 8.92278299e-01f, 8.94173214e-01f, 8.96053289e-01f, 8.97918452e-01f, 8.99768635e-01f,
+    9.01603766e-01f, 9.03423777e-01f, 9.05228599e-01f, 9.07018165e-01f, 9.08792407e-01f, 9.10551257e-01f, 9.12294651e-01f, 9.14022523e-01f,
+    9.15734806e-01f, 9.17431437e-01f, 9.19112353e-01f, 9.20777489e-01f, 9.22426783e-01f, 9.24060172e-01f, 9.25677597e-01f, 9.27278994e-01f,
+    9.28864305e-01f, 9.30433469e-01f, 9.31986428e-01f, 9.33523123e-01f, 9.35043496e-01f, 9.36547489e-01f, 9.38035047e-01f, 9.39506113e-01f,
+    9.40960632e-01f, 9.42398549e-01f, 9.43819810e-01f, 9.45224362e-01f, 9.46612151e-01f, 9.47983125e-01f, 9.49337233e-01f, 9.50674424e-01f,
+    9.51994647e-01f, 9.53297852e-01f, 9.54583992e-01f, 9.55853016e-01f, 9.57104878e-01f, 9.58339530e-01f, 9.59556926e-01f, 9.60757020e-01f,
+    9.61939766e-01f, 9.63105121e-01f, 9.64253040e-01f, 9.65383481e-01f, 9.66496399e-01f, 9.67591755e-01f, 9.68669506e-01f, 9.69729612e-01f,
+    9.70772033e-01f, 9.71796729e-01f, 9.72803663e-01f, 9.73792796e-01f, 9.74764090e-01f, 9.75717510e-01f, 9.76653020e-01f, 9.77570584e-01f,
+    9.78470168e-01f, 9.79351737e-01f, 9.80215260e-01f, 9.81060702e-01f, 9.81888033e-01f, 9.82697221e-01f, 9.83488236e-01f, 9.84261047e-01f,
+    9.85015627e-01f, 9.85751945e-01f, 9.86469976e-01f, 9.87169691e-01f, 9.87851065e-01f, 9.88514071e-01f, 9.89158685e-01f, 9.89784883e-01f,
+    9.90392640e-01f, 9.90981935e-01f, 9.91552744e-01f, 9.92105046e-01f, 9.92638821e-01f, 9.93154049e-01f, 9.93650709e-01f, 9.94128784e-01f,
+    9.94588255e-01f, 9.95029105e-01f, 9.95451318e-01f, 9.95854877e-01f, 9.96239767e-01f, 9.96605975e-01f, 9.96953485e-01f, 9.97282285e-01f,
+    9.97592363e-01f, 9.97883707e-01f, 9.98156306e-01f, 9.98410150e-01f, 9.98645228e-01f, 9.98861533e-01f, 9.99059056e-01f, 9.99237790e-01f,
+    9.99397728e-01f, 9.99538864e-01f, 9.99661192e-01f, 9.99764709e-01f, 9.99849409e-01f, 9.99915291e-01f, 9.99962351e-01f, 9.99990588e-01f,
+    1.00000000e+00f, 9.99990588e-01f, 9.99962351e-01f, 9.99915291e-01f, 9.99849409e-01f, 9.99764709e-01f, 9.99661192e-01f, 9.99538864e-01f,
+    9.99397728e-01f, 9.99237790e-01f, 9.99059056e-01f, 9.98861533e-01f, 9.98645228e-01f, 9.98410150e-01f, 9.98156306e-01f, 9.97883707e-01f,
+    9.97592363e-01f, 9.97282285e-01f, 9.96953485e-01f, 9.96605975e-01f, 9.96239767e-01f, 9.95854877e-01f, 9.95451318e-01f, 9.95029105e-01f,
+    9.94588255e-01f, 9.94128784e-01f, 9.93650709e-01f, 9.93154049e-01f, 9.92638821e-01f, 9.92105046e-01f, 9.91552744e-01f, 9.90981935e-01f,
+    9.90392640e-01f, 9.89784883e-01f, 9.89158685e-01f, 9.88514071e-01f, 9.87851065e-01f, 9.87169691e-01f, 9.86469976e-01f, 9.85751945e-01f,
+    9.85015627e-01f, 9.84261047e-01f, 9.83488236e-01f, 9.82697221e-01f, 9.81888033e-01f, 9.81060702e-01f, 9.80215260e-01f, 9.79351737e-01f,
+    9.78470168e-01f, 9.77570584e-01f, 9.76653020e-01f, 9.75717510e-01f, 9.74764090e-01f, 9.73792796e-01f, 9.72803663e-01f, 9.71796729e-01f,
+    9.70772033e-01f, 9.69729612e-01f, 9.68669506e-01f, 9.67591755e-01f, 9.66496399e-01f, 9.65383481e-01f, 9.64253040e-01f, 9.63105121e-01f,
+    9.61939766e-01f, 9.60757020e-01f, 9.59556926e-01f, 9.58339530e-01f, 9.57104878e-01f, 9.55853016e-01f, 9.54583992e-01f, 9.53297852e-01f,
+    9.51994647e-01f, 9.50674424e-01f, 9.49337233e-01f, 9.47983125e-01f, 9.46612151e-01f, 9.45224362e-01f, 9.43819810e-01f, 9.42398549e-01f,
+    9.40960632e-01f, 9.39506113e-01f, 9.38035047e-01f, 9.36547489e-01f, 9.35043496e-01f, 9.33523123e-01f, 9.31986428e-01f, 9.30433469e-01f,
+    9.28864305e-01f, 9.27278994e-01f, 9.25677597e-01f, 9.24060172e-01f, 9.22426783e-01f, 9.20777489e-01f, 9.19112353e-01f, 9.17431437e-01f,
+    9.15734806e-01f, 9.14022523e-01f, 9.12294651e-01f, 9.10551257e-01f, 9.08792407e-01f, 9.07018165e-01f, 9.05228599e-01f, 9.03423777e-01f,
+    9.01603766e-01f, 8.99768635e-01f, 8.97918452e-01f, 8.96053289e-01f, 8.94173214e-01f, 8.92278299e-01f, 8.90368614e-01f, 8.88444233e-01f,
+    8.86505227e-01f, 8.84551669e-01f, 8.82583633e-01f, 8.80601193e-01f, 8.78604423e-01f, 8.76593400e-01f, 8.74568197e-01f, 8.72528893e-01f,
+    8.70475563e-01f, 8.68408284e-01f, 8.66327136e-01f, 8.64232195e-01f, 8.62123541e-01f, 8.60001254e-01f, 8.57865413e-01f, 8.55716098e-01f,
+    8.53553391e-01f, 8.51377372e-01f, 8.49188125e-01f, 8.46985730e-01f, 8.44770272e-01f, 8.42541834e-01f, 8.40300499e-01f, 8.38046352e-01f,
+    8.35779477e-01f, 8.33499961e-01f, 8.31207889e-01f, 8.28903347e-01f, 8.26586421e-01f, 8.24257201e-01f, 8.21915771e-01f, 8.19562222e-01f,
+    8.17196642e-01f, 8.14819119e-01f, 8.12429744e-01f, 8.10028606e-01f, 8.07615795e-01f, 8.05191403e-01f, 8.02755521e-01f, 8.00308240e-01f,
+    7.97849652e-01f, 7.95379851e-01f, 7.92898929e-01f, 7.90406979e-01f, 7.87904096e-01f, 7.85390373e-01f, 7.82865905e-01f, 7.80330788e-01f,
+    7.77785117e-01f, 7.75228986e-01f, 7.72662494e-01f, 7.70085736e-01f, 7.67498810e-01f, 7.64901812e-01f, 7.62294841e-01f, 7.59677995e-01f,
+    7.57051372e-01f, 7.54415071e-01f, 7.51769192e-01f, 7.49113833e-01f, 7.46449096e-01f, 7.43775080e-01f, 7.41091886e-01f, 7.38399615e-01f,
+    7.35698368e-01f, 7.32988248e-01f, 7.30269355e-01f, 7.27541794e-01f, 7.24805665e-01f, 7.22061072e-01f, 7.19308119e-01f, 7.16546909e-01f,
+    7.13777547e-01f, 7.11000135e-01f, 7.08214780e-01f, 7.05421586e-01f, 7.02620657e-01f, 6.99812100e-01f, 6.96996020e-01f, 6.94172523e-01f,
+    6.91341716e-01f, 6.88503705e-01f, 6.85658597e-01f, 6.82806499e-01f, 6.79947518e-01f, 6.77081763e-01f, 6.74209340e-01f, 6.71330359e-01f,
+    6.68444927e-01f, 6.65553153e-01f, 6.62655146e-01f, 6.59751015e-01f, 6.56840870e-01f, 6.53924820e-01f, 6.51002975e-01f, 6.48075444e-01f,
+    6.45142339e-01f, 6.42203769e-01f, 6.39259845e-01f, 6.36310678e-01f, 6.33356379e-01f, 6.30397059e-01f, 6.27432830e-01f, 6.24463803e-01f,
+    6.21490090e-01f, 6.18511803e-01f, 6.15529054e-01f, 6.12541956e-01f, 6.09550620e-01f, 6.06555160e-01f, 6.03555688e-01f, 6.00552317e-01f,
+    5.97545161e-01f, 5.94534332e-01f, 5.91519944e-01f, 5.88502110e-01f, 5.85480944e-01f, 5.82456560e-01f, 5.79429072e-01f, 5.76398593e-01f,
+    5.73365237e-01f, 5.70329120e-01f, 5.67290354e-01f, 5.64249055e-01f, 5.61205338e-01f, 5.58159315e-01f, 5.55111104e-01f, 5.52060817e-01f,
+    5.49008570e-01f, 5.45954478e-01f, 5.42898656e-01f, 5.39841219e-01f, 5.36782282e-01f, 5.33721960e-01f, 5.30660368e-01f, 5.27597622e-01f,
+    5.24533837e-01f, 5.21469128e-01f, 5.18403611e-01f, 5.15337402e-01f, 5.12270614e-01f, 5.09203365e-01f, 5.06135769e-01f, 5.03067942e-01f,
+    5.00000000e-01f, 4.96932058e-01f, 4.93864231e-01f, 4.90796635e-01f, 4.87729386e-01f, 4.84662598e-01f, 4.81596389e-01f, 4.78530872e-01f,
+    4.75466163e-01f, 4.72402378e-01f, 4.69339632e-01f, 4.66278040e-01f, 4.63217718e-01f, 4.60158781e-01f, 4.57101344e-01f, 4.54045522e-01f,
+    4.50991430e-01f, 4.47939183e-01f, 4.44888896e-01f, 4.41840685e-01f, 4.38794662e-01f, 4.35750945e-01f, 4.32709646e-01f, 4.29670880e-01f,
+    4.26634763e-01f, 4.23601407e-01f, 4.20570928e-01f, 4.17543440e-01f, 4.14519056e-01f, 4.11497890e-01f, 4.08480056e-01f, 4.05465668e-01f,
+    4.02454839e-01f, 3.99447683e-01f, 3.96444312e-01f, 3.93444840e-01f, 3.90449380e-01f, 3.87458044e-01f, 3.84470946e-01f, 3.81488197e-01f,
+    3.78509910e-01f, 3.75536197e-01f, 3.72567170e-01f, 3.69602941e-01f, 3.66643621e-01f, 3.63689322e-01f, 3.60740155e-01f, 3.57796231e-01f,
+    3.54857661e-01f, 3.51924556e-01f, 3.48997025e-01f, 3.46075180e-01f, 3.43159130e-01f, 3.40248985e-01f, 3.37344854e-01f, 3.34446847e-01f,
+    3.31555073e-01f, 3.28669641e-01f, 3.25790660e-01f, 3.22918237e-01f, 3.20052482e-01f, 3.17193501e-01f, 3.14341403e-01f, 3.11496295e-01f,
+    3.08658284e-01f, 3.05827477e-01f, 3.03003980e-01f, 3.00187900e-01f, 2.97379343e-01f, 2.94578414e-01f, 2.91785220e-01f, 2.88999865e-01f,
+    2.86222453e-01f, 2.83453091e-01f, 2.80691881e-01f, 2.77938928e-01f, 2.75194335e-01f, 2.72458206e-01f, 2.69730645e-01f, 2.67011752e-01f,
+    2.64301632e-01f, 2.61600385e-01f, 2.58908114e-01f, 2.56224920e-01f, 2.53550904e-01f, 2.50886167e-01f, 2.48230808e-01f, 2.45584929e-01f,
+    2.42948628e-01f, 2.40322005e-01f, 2.37705159e-01f, 2.35098188e-01f, 2.32501190e-01f, 2.29914264e-01f, 2.27337506e-01f, 2.24771014e-01f,
+    2.22214883e-01f, 2.19669212e-01f, 2.17134095e-01f, 2.14609627e-01f, 2.12095904e-01f, 2.09593021e-01f, 2.07101071e-01f, 2.04620149e-01f,
+    2.02150348e-01f, 1.99691760e-01f, 1.97244479e-01f, 1.94808597e-01f, 1.92384205e-01f, 1.89971394e-01f, 1.87570256e-01f, 1.85180881e-01f,
+    1.82803358e-01f, 1.80437778e-01f, 1.78084229e-01f, 1.75742799e-01f, 1.73413579e-01f, 1.71096653e-01f, 1.68792111e-01f, 1.66500039e-01f,
+    1.64220523e-01f, 1.61953648e-01f, 1.59699501e-01f, 1.57458166e-01f, 1.55229728e-01f, 1.53014270e-01f, 1.50811875e-01f, 1.48622628e-01f,
+    1.46446609e-01f, 1.44283902e-01f, 1.42134587e-01f, 1.39998746e-01f, 1.37876459e-01f, 1.35767805e-01f, 1.33672864e-01f, 1.31591716e-01f,
+    1.29524437e-01f, 1.27471107e-01f, 1.25431803e-01f, 1.23406600e-01f, 1.21395577e-01f, 1.19398807e-01f, 1.17416367e-01f, 1.15448331e-01f,
+    1.13494773e-01f, 1.11555767e-01f, 1.09631386e-01f, 1.07721701e-01f, 1.05826786e-01f, 1.03946711e-01f, 1.02081548e-01f, 1.00231365e-01f,
+    9.83962343e-02f, 9.65762232e-02f, 9.47714009e-02f, 9.29818351e-02f, 9.12075934e-02f, 8.94487425e-02f, 8.77053486e-02f, 8.59774774e-02f,
+    8.42651938e-02f, 8.25685625e-02f, 8.08876472e-02f, 7.92225113e-02f, 7.75732174e-02f, 7.59398276e-02f, 7.43224034e-02f, 7.27210058e-02f,
+    7.11356950e-02f, 6.95665307e-02f, 6.80135719e-02f, 6.64768772e-02f, 6.49565044e-02f, 6.34525108e-02f, 6.19649529e-02f, 6.04938868e-02f,
+    5.90393678e-02f, 5.76014508e-02f, 5.61801898e-02f, 5.47756384e-02f, 5.33878494e-02f, 5.20168751e-02f, 5.06627672e-02f, 4.93255765e-02f,
+    4.80053534e-02f, 4.67021477e-02f, 4.54160085e-02f, 4.41469840e-02f, 4.28951221e-02f, 4.16604700e-02f, 4.04430742e-02f, 3.92429803e-02f,
+    3.80602337e-02f, 3.68948789e-02f, 3.57469598e-02f, 3.46165195e-02f, 3.35036006e-02f, 3.24082450e-02f, 3.13304940e-02f, 3.02703882e-02f,
+    2.92279674e-02f, 2.82032709e-02f, 2.71963373e-02f, 2.62072045e-02f, 2.52359097e-02f, 2.42824895e-02f, 2.33469798e-02f, 2.24294158e-02f,
+    2.15298321e-02f, 2.06482626e-02f, 1.97847403e-02f, 1.89392979e-02f, 1.81119671e-02f, 1.73027792e-02f, 1.65117645e-02f, 1.57389529e-02f,
+    1.49843734e-02f, 1.42480545e-02f, 1.35300239e-02f, 1.28303086e-02f, 1.21489350e-02f, 1.14859287e-02f, 1.08413146e-02f, 1.02151172e-02f,
+    9.60735980e-03f, 9.01806545e-03f, 8.44725628e-03f, 7.89495381e-03f, 7.36117881e-03f, 6.84595138e-03f, 6.34929092e-03f, 5.87121613e-03f,
+    5.41174502e-03f, 4.97089487e-03f, 4.54868229e-03f, 4.14512317e-03f, 3.76023270e-03f, 3.39402538e-03f, 3.04651500e-03f, 2.71771463e-03f,
+    2.40763666e-03f, 2.11629277e-03f, 1.84369391e-03f, 1.58985035e-03f, 1.35477166e-03f, 1.13846668e-03f, 9.40943550e-04f, 7.62209713e-04f,
+    6.02271897e-04f, 4.61136124e-04f, 3.38807706e-04f, 2.35291249e-04f, 1.50590652e-04f, 8.47091021e-05f, 3.76490804e-05f, 9.41235870e-06f
+};
+
+#endif /* HANN_H */
@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+"""Record the peripheral's microphone to a WAV file through the base node.
+
+Start the stream from the base node shell:
+
+    audio start            # 8 kHz
+    audio stop
+
+"audio start 16000" (full rate) needs a console faster than 115200
+baud; the base node refuses rates its console cannot carry.
+
+then point this at the base node's serial port (needs pyserial) or at a
+captured log:
+
+    scripts/audio_capture.py --port /dev/ttyACM0 -o take1.wav --seconds 30
+    scripts/audio_capture.py -o take1.wav < central.log
+
+Each AU line is one 20-byte NUS_FRAME_AUDIO packet (format in
+common/nus_proto.h): 28 IMA-ADPCM samples with the encoder state they
+start from, so every packet decodes on its own. Missing sequence
+numbers are filled with silence to keep the recording in time, and
+reported at the end together with the achieved sample rate.
+
+Every "AUDIO <rate>" line the base node prints on `audio start` begins a
+new take: a second start in the same log goes to take1-2.wav and so on,
+so takes at different rates never share a WAV header.
+"""
+
+import argparse
+import base64
+import os
+import re
+import struct
+import sys
+import time
+import wave
+
+AUDIO = re.compile(r"AUDIO (\d+)")
+AU = re.compile(r"AU ([A-Za-z0-9+/=]+)")
+FRAME_AUDIO = 0xA5
+SAMPLES = 28
+
+STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37,
+    41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173,
+    190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+    724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484,
+    7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818,
+    18500, 20350, 22385, 24623, 27086, 29794, 32767,
+]
+INDEX = [-1, -1, -1, -1, 2, 4, 6, 8] * 2
+
+
+def decode_packet(pkt):
+    """Return (seq, [28 samples]) for one packet, or None if malformed."""
+    if len(pkt) < 20 or pkt[0] != FRAME_AUDIO:
+        return None
+    _, seq, pred, index = struct.unpack_from("<BHhB", pkt)
+    data = pkt[6:20]
+    out = []
+    for i in range(SAMPLES):
+        nib = (data[i // 2] >> (4 * (i & 1))) & 0x0F
+        step = STEPS[index]
+        diff = step >> 3
+        if nib & 4:
+            diff += step
+        if nib & 2:
+            diff += step >> 1
+        if nib & 1:
+            diff += step >> 2
+        pred = max(-32768, min(32767, pred - diff if nib & 8 else pred + diff))
+        index = max(0, min(88, index + INDEX[nib]))
+        out.append(pred)
+    return seq, out
+
+
+class Recorder:
+    def __init__(self):
+        self.start(8000)
+
+    def start(self, rate):
+        """Begin a new take: nothing of the previous one carries over."""
+        self.rate = rate
+        self.samples = []
+        self.last_seq = None
+        self.packets = 0
+        self.gaps = 0
+        self.missing = 0
+        self.first_t = None
+        self.last_t = None
+
+    def feed(self, pkt):
+        res = decode_packet(pkt)
+        if res is None:
+            return
+        seq, pcm = res
+        now = time.monotonic()
+        if self.first_t is None:
+            self.first_t = now
+        self.last_t = now
+        if self.last_seq is not None:
+            lost = (seq - self.last_seq - 1) % 65536
+            if lost >= 32768:       # late duplicate or a restarted stream
+                lost = 0
+            if lost:
+                self.gaps += 1
+                self.missing += lost
+                self.samples += [0] * (lost * SAMPLES)
+        self.last_seq = seq
+        self.packets += 1
+        self.samples += pcm
+
+    def write(self, path):
+        with wave.open(path, "wb") as w:
+            w.setnchannels(1)
+            w.setsampwidth(2)
+            w.setframerate(self.rate)
+            w.writeframes(struct.pack(f"<{len(self.samples)}h", *self.samples))
+
+
+def lines(args):
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=1) as ser:
+            while True:
+                yield ser.readline().decode(errors="replace")
+    else:
+        yield from sys.stdin
+
+
+def take_path(output, take):
+    if take == 1:
+        return output
+    root, ext = os.path.splitext(output)
+    return f"{root}-{take}{ext or '.wav'}"
+
+
+def finish(rec, path, live):
+    rec.write(path)
+    total = rec.packets + rec.missing
+    print(f"wrote {path}: {len(rec.samples) / rec.rate:.2f} s at {rec.rate} Hz",
+          file=sys.stderr)
+    print(f"packets {rec.packets}, gaps {rec.gaps} ({rec.missing} packets,"
+          f" {100.0 * rec.missing / total if total else 0:.2f}% silence-filled)",
+          file=sys.stderr)
+    if live and rec.first_t is not None and rec.last_t > rec.first_t:
+        wall = rec.last_t - rec.first_t
+        got = (rec.packets - 1) * SAMPLES / wall
+        print(f"delivered {got:.0f} samples/s of {rec.rate}"
+              f" ({'real time' if got >= 0.99 * rec.rate else 'behind'})",
+              file=sys.stderr)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--port", help="base node serial port (default: stdin)")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("-o", "--output", default="capture.wav", help="WAV to write")
+    ap.add_argument("--seconds", type=float,
+                    help="stop after this much audio (default: until EOF/Ctrl-C)")
+    args = ap.parse_args()
+
+    rec = Recorder()
+    take = 1
+    try:
+        for line in lines(args):
+            m = AUDIO.search(line)
+            if m:
+                if rec.packets:
+                    finish(rec, take_path(args.output, take), args.port)
+                    take += 1
+                rec.start(int(m.group(1)))
+                continue
+            m = AU.search(line)
+            if not m:
+                continue
+            try:
+                rec.feed(base64.b64decode(m.group(1)))
+            except ValueError:
+                continue
+            if args.seconds and len(rec.samples) >= args.seconds * rec.rate:
+                break
+    except KeyboardInterrupt:
+        pass
+
+    if rec.packets or take == 1:
+        finish(rec, take_path(args.output, take), args.port)
+
+
+if __name__ == "__main__":
+    main()
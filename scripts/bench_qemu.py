@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""DSP kernel benchmarks (bench/) on a Cortex-M4F under QEMU.
+
+Builds the ztest suite in bench/ for mps2/an386, runs it under QEMU
+with instruction counting and reports, per kernel call, instructions
+and timer cycles. The suite's golden-output assertions run as part of
+it; any failure fails this script.
+
+QEMU runs with -icount, so virtual time advances 2^shift ns per
+instruction and the counts are exactly repeatable from run to run.
+That makes them a regression gate: record a baseline, then compare:
+
+    scripts/bench_qemu.py --build --save bench/baseline.json
+    scripts/bench_qemu.py --build --baseline bench/baseline.json \\
+        --max-regress 2
+
+Instruction counts say nothing about wait states or FPU stalls on a
+real Thingy:52; build bench/ for the board itself for real cycles.
+
+Needs ZEPHYR_BASE and west on PATH, as for any Zephyr build.
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.join(HERE, "..")
+BOARD = "mps2/an386"
+SHIFT = 3                           # 8 ns per instruction
+
+BENCH = re.compile(r"BENCH (\S+) cycles (\d+) ns (\d+)")
+DONE = re.compile(r"PROJECT EXECUTION (SUCCESSFUL|FAILED)")
+FAILED = re.compile(r"^\s*(FAIL|Assertion failed).*", re.M)
+ICOUNT = re.compile(r"^CONFIG_QEMU_ICOUNT_SHIFT=(\d+)", re.M)
+
+
+def build(build_dir):
+    subprocess.run(["west", "build", "-p", "auto", "-b", BOARD,
+                    "-d", build_dir, os.path.join(ROOT, "bench")], check=True)
+
+
+def icount_shift(build_dir):
+    """The board's own icount setting, if it has one."""
+    try:
+        with open(os.path.join(build_dir, "zephyr", ".config")) as f:
+            config = f.read()
+    except OSError:
+        return None
+    m = ICOUNT.search(config)
+    if m and "CONFIG_QEMU_ICOUNT=y" in config:
+        return int(m.group(1))
+    return None
+
+
+def run(build_dir, timeout_s, verbose):
+    """Run under QEMU until the suite reports; returns (output, shift)."""
+    env = dict(os.environ)
+    shift = icount_shift(build_dir)
+    if shift is None:
+        shift = SHIFT
+        env["QEMU_EXTRA_FLAGS"] = f"-icount shift={shift},align=off,sleep=off"
+
+    proc = subprocess.Popen(["west", "build", "-d", build_dir, "-t", "run"],
+                            stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            text=True, env=env)
+    out = []
+    deadline = time.monotonic() + timeout_s
+    for line in proc.stdout:
+        out.append(line)
+        if verbose:
+            sys.stdout.write(line)
+        if DONE.search(line) or time.monotonic() > deadline:
+            break
+    proc.terminate()
+    proc.wait()
+    return "".join(out), shift
+
+
+def parse(output, shift):
+    results = {}
+    for name, cycles, ns in BENCH.findall(output):
+        results[name] = {"cycles": int(cycles), "instr": int(ns) >> shift}
+    return results
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--build", action="store_true", help="west build bench/ first")
+    ap.add_argument("--build-dir", default=os.path.join(ROOT, "build_bench"))
+    ap.add_argument("--timeout", type=float, default=120.0, help="seconds")
+    ap.add_argument("--save", help="write the results as a JSON baseline")
+    ap.add_argument("--baseline", help="JSON baseline to compare against")
+    ap.add_argument("--max-regress", type=float, default=2.0,
+                    help="fail above this instruction count increase, %%")
+    ap.add_argument("-v", "--verbose", action="store_true", help="echo device output")
+    args = ap.parse_args()
+
+    if "ZEPHYR_BASE" not in os.environ:
+        sys.exit("ZEPHYR_BASE is not set")
+
+    if args.build:
+        build(args.build_dir)
+
+    output, shift = run(args.build_dir, args.timeout, args.verbose)
+    results = parse(output, shift)
+    done = DONE.search(output)
+
+    base = {}
+    if args.baseline:
+        with open(args.baseline) as f:
+            base = json.load(f)
+
+    print(f"{'kernel':<16} {'instr':>9} {'cycles':>9} {'vs base':>9}")
+    failed = []
+    for name, r in results.items():
+        delta = ""
+        if name in base and base[name]["instr"]:
+            pct = 100.0 * (r["instr"] - base[name]["instr"]) / base[name]["instr"]
+            delta = f"{pct:+.1f}%"
+            if pct > args.max_regress:
+                failed.append(f"{name} {pct:+.1f}% instructions")
+        print(f"{name:<16} {r['instr']:>9} {r['cycles']:>9} {delta:>9}")
+    for name in base:
+        if name not in results:
+            failed.append(f"{name} did not report")
+
+    if not done:
+        failed.append("suite did not finish")
+    elif done.group(1) != "SUCCESSFUL":
+        failed.extend(m.group(0).strip() for m in FAILED.finditer(output))
+        failed.append("golden-output checks failed")
+
+    if args.save and not failed:
+        with open(args.save, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+            f.write("\n")
+
+    for f in failed:
+        print(f"FAIL: {f}", file=sys.stderr)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
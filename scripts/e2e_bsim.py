@@ -0,0 +1,312 @@
+#!/usr/bin/env python3
+"""Two-node end-to-end run on BabbleSim: dsp (peripheral) + ble_central.
+
+Both apps are built for nrf52_bsim. The peripheral's microphone is the
+WAV-fed DMIC emulator (dsp/lib/dmic_wav); the base node prints an "E2E"
+summary line every second (CONFIG_APP_E2E_SUMMARY) and reads the
+peripheral's loss counters over GATT. This script runs the simulated
+radio plus both devices, then reports delivered frames/s, capture-to-
+parse latency and where frames were dropped.
+
+Needs ZEPHYR_BASE, BSIM_OUT_PATH and BSIM_COMPONENTS_PATH as for any
+bsim build, and west on PATH:
+
+    scripts/e2e_bsim.py --build                    # synthetic guitar WAV
+    scripts/e2e_bsim.py --wav take1.wav --seconds 60 \\
+        --min-fps 5 --max-latency-ms 120 --max-lost 0
+    scripts/e2e_bsim.py --noise mix --snr-db 6 --max-settle-frames 8
+    scripts/e2e_bsim.py --build --noise mix --spectral-mode welch \\
+        --noise-capture 16
+
+--noise mixes mains hum, fan noise or both plus a competing instrument
+into the synthetic WAV. For each note the base node reports, "settle"
+counts frames until its filtered pitch stays within 5 cents of the
+nearest open string; a note that never does counts all of its frames.
+
+--spectral-mode and --noise-capture set the peripheral's boot-time
+averaging mode and noise capture (CONFIG_APP_SPECTRAL_AVG_MODE,
+CONFIG_APP_NOISE_CAPTURE_FRAMES), so they need --build. With a noise
+capture the synthetic WAV starts with background alone, long enough
+for those frames at the slowest (10/s) analysis rate.
+
+Exit status is non-zero when a gate (--min-fps, --max-latency-ms,
+--max-lost) fails, so it can run as a CI step on a plain Linux box.
+"""
+
+import argparse
+import math
+import os
+import random
+import re
+import struct
+import subprocess
+import sys
+import threading
+import wave
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.join(HERE, "..")
+BOARD = "nrf52_bsim"
+
+BSIM_PREFIX = re.compile(r"^d_\d+: @[\d:.]+\s+")
+E2E = re.compile(r"E2E (.*)$")
+KV = re.compile(r"(\w+)=(\d+)")
+PEER_CTR = re.compile(r"^\s*(\S.*?)\s+(\d+)$")
+
+PITCH = re.compile(r"^(\d+\.\d+) (\S+)")
+
+STRINGS_HZ = (82.41, 110.00, 146.83, 196.00, 246.94, 329.63)  # E2 .. E4
+NOISES = ("none", "hum", "fan", "mix")
+SPECTRAL_MODES = ("off", "ewma", "welch")   # CONFIG_APP_SPECTRAL_AVG_MODE
+SETTLE_CENTS = 5.0
+SETTLE_HOLD = 3
+
+
+def noise_sample(kind, t, rng, state):
+    """One sample of unit-ish RMS background noise."""
+    v = 0.0
+    if kind in ("hum", "mix"):
+        # 50 Hz mains with the odd harmonics a transformer adds
+        v += sum(math.sin(2 * math.pi * 50 * h * t) / h for h in (1, 3, 5))
+    if kind in ("fan", "mix"):
+        # one-pole low-passed white noise plus a blade tone
+        state[0] += 0.1 * (rng.gauss(0, 3.0) - state[0])
+        v += state[0] + 0.3 * math.sin(2 * math.pi * 180 * t)
+    if kind == "mix":
+        # another instrument holding a note between the strings
+        v += 0.5 * math.sin(2 * math.pi * 277.18 * t)
+    return v
+
+
+def synth_wav(path, rate=16000, note_s=2.0, noise="none", snr_db=10.0,
+              lead_s=0.0):
+    """Each open string plucked in turn: decaying harmonics plus noise,
+    after lead_s of the noise alone."""
+    rng = random.Random(1)
+    state = [0.0]
+    noise_amp = 6000 / math.sqrt(2) * 10 ** (-snr_db / 20)
+    frames = bytearray()
+    for n in range(int(lead_s * rate)):
+        v = rng.gauss(0, 150)
+        if noise != "none":
+            v += noise_amp * noise_sample(noise, n / rate, rng, state)
+        frames += struct.pack("<h", max(-32768, min(32767, int(v))))
+    for f0 in STRINGS_HZ:
+        for n in range(int(note_s * rate)):
+            t = n / rate
+            env = math.exp(-1.5 * t)
+            s = sum(math.sin(2 * math.pi * f0 * h * t) / h for h in (1, 2, 3))
+            v = 6000 * env * s + rng.gauss(0, 150)
+            if noise != "none":
+                v += noise_amp * noise_sample(noise, t, rng, state)
+            frames += struct.pack("<h", max(-32768, min(32767, int(v))))
+    with wave.open(path, "wb") as w:
+        w.setnchannels(1)
+        w.setsampwidth(2)
+        w.setframerate(rate)
+        w.writeframes(bytes(frames))
+
+
+def build(app, build_dir, configs=()):
+    cmd = ["west", "build", "-p", "auto", "-b", BOARD,
+           "-d", build_dir, os.path.join(ROOT, app)]
+    if configs:
+        cmd += ["--"] + [f"-D{c}" for c in configs]
+    subprocess.run(cmd, check=True)
+
+
+def run(args, dsp_exe, central_exe, wav):
+    bsim_bin = os.path.join(os.environ["BSIM_OUT_PATH"], "bin")
+    sim_id = f"apollo_e2e_{os.getpid()}"
+    sim_us = str(int(args.seconds * 1e6))
+
+    # The devices run in lockstep with the phy: if either one's stdout pipe
+    # fills the whole simulation stalls, so both are drained at once
+    out = {}
+
+    def drain(name, proc):
+        out[name] = proc.stdout.read()
+
+    procs = [
+        subprocess.Popen([os.path.join(bsim_bin, "bs_2G4_phy_v1"),
+                          f"-s={sim_id}", "-D=2", f"-sim_length={sim_us}"],
+                         cwd=bsim_bin, stdout=subprocess.DEVNULL),
+        subprocess.Popen([dsp_exe, f"-s={sim_id}", "-d=0", f"-wav={wav}"],
+                         cwd=bsim_bin, stdout=subprocess.PIPE, text=True),
+        subprocess.Popen([central_exe, f"-s={sim_id}", "-d=1"],
+                         cwd=bsim_bin, stdout=subprocess.PIPE, text=True),
+    ]
+    readers = [threading.Thread(target=drain, args=(name, proc))
+               for name, proc in (("dsp", procs[1]), ("central", procs[2]))]
+    for r in readers:
+        r.start()
+    for r in readers:
+        r.join()
+    for p in procs:
+        p.wait()
+
+    if args.verbose:
+        sys.stdout.write(out["dsp"])
+        sys.stdout.write(out["central"])
+    return out["central"]
+
+
+def cents_off(freq):
+    ref = min(STRINGS_HZ, key=lambda f: abs(math.log2(freq / f)))
+    return 1200 * math.log2(freq / ref)
+
+
+def settle_frames(pitches):
+    """Frames from each reported note change until the filtered pitch
+    holds within SETTLE_CENTS, per note, and how many notes settled at
+    all. A note that never settles counts every frame it was reported."""
+    runs = []
+    start = 0
+    for i in range(1, len(pitches) + 1):
+        if i == len(pitches) or pitches[i][1] != pitches[start][1]:
+            runs.append(pitches[start:i])
+            start = i
+    frames = []
+    settled = 0
+    for run in runs:
+        ok = [abs(cents_off(f)) <= SETTLE_CENTS for f, _ in run]
+        for i in range(len(ok) - SETTLE_HOLD + 1):
+            if all(ok[i:i + SETTLE_HOLD]):
+                frames.append(i + 1)
+                settled += 1
+                break
+        else:
+            frames.append(len(run))
+    return frames, settled
+
+
+def parse(central_out):
+    """Return ([summary dicts], {peripheral counter: value}, [(Hz, note)])
+    from the base node."""
+    summaries = []
+    peer = {}
+    pitches = []
+    in_peer = False
+    for line in central_out.splitlines():
+        line = BSIM_PREFIX.sub("", line)
+        p = PITCH.match(line)
+        if p and float(p.group(1)) > 0:
+            pitches.append((float(p.group(1)), p.group(2)))
+        m = E2E.search(line)
+        if m:
+            summaries.append({k: int(v) for k, v in KV.findall(m.group(1))})
+            in_peer = False
+        elif line.strip() == "peripheral:":
+            in_peer = True
+            peer = {}
+        elif in_peer and PEER_CTR.match(line):
+            m = PEER_CTR.match(line)
+            peer[m.group(1)] = int(m.group(2))
+        else:
+            in_peer = False
+    return summaries, peer, pitches
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--wav", help="16-bit PCM input (default: synthetic EADGBE plucks)")
+    ap.add_argument("--seconds", type=float, default=30.0, help="simulated time")
+    ap.add_argument("--build", action="store_true", help="west build both apps first")
+    ap.add_argument("--build-dir", default=os.path.join(ROOT, "build_bsim"))
+    ap.add_argument("--min-fps", type=float, help="fail below this delivered rate")
+    ap.add_argument("--max-latency-ms", type=float, help="fail above this mean latency")
+    ap.add_argument("--max-lost", type=int, help="fail above this many lost frames")
+    ap.add_argument("--noise", choices=NOISES, default="none",
+                    help="background mixed into the synthetic WAV")
+    ap.add_argument("--snr-db", type=float, default=10.0,
+                    help="string peak to background noise ratio")
+    ap.add_argument("--max-settle-frames", type=float,
+                    help="fail above this mean frames-to-stable per note,"
+                         " or if any note never settles")
+    ap.add_argument("--spectral-mode", choices=SPECTRAL_MODES,
+                    help="peripheral averaging mode at boot (with --build)")
+    ap.add_argument("--noise-capture", type=int, metavar="FRAMES",
+                    help="learn the noise profile over the first FRAMES"
+                         " frames after boot (with --build)")
+    ap.add_argument("-v", "--verbose", action="store_true", help="echo device output")
+    args = ap.parse_args()
+
+    for var in ("ZEPHYR_BASE", "BSIM_OUT_PATH"):
+        if var not in os.environ:
+            sys.exit(f"{var} is not set")
+
+    dsp_configs = []
+    if args.spectral_mode is not None:
+        mode = SPECTRAL_MODES.index(args.spectral_mode)
+        dsp_configs.append(f"CONFIG_APP_SPECTRAL_AVG_MODE={mode}")
+    if args.noise_capture is not None:
+        if not 0 <= args.noise_capture <= 255:
+            sys.exit("--noise-capture must be 0..255 frames")
+        dsp_configs.append(f"CONFIG_APP_NOISE_CAPTURE_FRAMES={args.noise_capture}")
+    if dsp_configs and not args.build:
+        sys.exit("--spectral-mode and --noise-capture are build options: add --build")
+
+    dsp_dir = os.path.join(args.build_dir, "dsp")
+    central_dir = os.path.join(args.build_dir, "ble_central")
+    if args.build:
+        build("dsp", dsp_dir, dsp_configs)
+        build("ble_central", central_dir)
+
+    wav = args.wav
+    if not wav:
+        os.makedirs(args.build_dir, exist_ok=True)
+        wav = os.path.join(args.build_dir, f"strings_{args.noise}.wav")
+        lead_s = 0.5 + 0.1 * args.noise_capture if args.noise_capture else 0.0
+        synth_wav(wav, noise=args.noise, snr_db=args.snr_db, lead_s=lead_s)
+    wav = os.path.abspath(wav)
+
+    central_out = run(args,
+                      os.path.join(dsp_dir, "zephyr", "zephyr.exe"),
+                      os.path.join(central_dir, "zephyr", "zephyr.exe"),
+                      wav)
+    summaries, peer, pitches = parse(central_out)
+    settle_runs, settled = settle_frames(pitches)
+    settle = sum(settle_runs) / len(settle_runs) if settle_runs else float("inf")
+
+    live = [s for s in summaries if s.get("pitch", 0) > 0]
+    if len(live) < 2:
+        print("no pitch frames delivered", file=sys.stderr)
+        return 1
+
+    first, last = live[0], live[-1]
+    span_s = (last["uptime_ms"] - first["uptime_ms"]) / 1000.0
+    fps = (last["pitch"] - first["pitch"]) / span_s if span_s > 0 else 0.0
+    lat_ms = last["lat_avg_us"] / 1000.0
+
+    print(f"frames delivered  {last['pitch']} ({fps:.2f}/s over {span_s:.0f} s)")
+    print(f"latency (total)   avg {lat_ms:.2f} ms, max {last['lat_max_us'] / 1000.0:.2f} ms"
+          f" over {last['lat_n']} frames")
+    print(f"lost (seq gaps)   {last['lost']}  out of order {last['old']}"
+          f"  central msgq full {last['msgq_full']}")
+    print(f"settle            {settle:.1f} frames/note avg,"
+          f" {settled}/{len(settle_runs)} notes within {SETTLE_CENTS:.0f} cents")
+    if peer:
+        print("peripheral:")
+        for name, value in peer.items():
+            print(f"  {name:<40} {value}")
+
+    failed = []
+    if args.min_fps is not None and fps < args.min_fps:
+        failed.append(f"fps {fps:.2f} < {args.min_fps}")
+    if args.max_latency_ms is not None and lat_ms > args.max_latency_ms:
+        failed.append(f"latency {lat_ms:.2f} ms > {args.max_latency_ms}")
+    if args.max_lost is not None and last["lost"] > args.max_lost:
+        failed.append(f"lost {last['lost']} > {args.max_lost}")
+    if args.max_settle_frames is not None:
+        if settle > args.max_settle_frames:
+            failed.append(f"settle {settle:.1f} frames > {args.max_settle_frames}")
+        if settled < len(settle_runs):
+            failed.append(f"{len(settle_runs) - settled} notes never settled")
+    for f in failed:
+        print(f"FAIL: {f}", file=sys.stderr)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
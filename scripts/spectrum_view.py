@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""Decode the base node's SPEC lines and show the peripheral's spectrum.
+
+Start the stream from the base node shell, e.g.
+
+    spectrum stream 4 1          # 4-bit deltas, every frame, tuning span
+
+then point this at the base node's serial port (needs pyserial) or at a
+captured log:
+
+    scripts/spectrum_view.py --port /dev/ttyACM0
+    scripts/spectrum_view.py --plot < central.log
+
+Each SPEC line is one spectrum as sent over BLE (format in
+common/nus_proto.h): a key frame of absolute levels or the change since
+the previous spectrum. After a gap in the sequence numbers nothing is
+shown until the next key frame.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SPEC = re.compile(r"SPEC (\d+) ([0-9a-f]{2}) ([0-9a-f]*)")
+KEY = 0x01
+NIBBLES = 0x02
+BAR_DB = 3.0      # one character per this many dB in text mode
+
+
+class Decoder:
+    def __init__(self):
+        self.levels = None
+        self.last_seq = None
+        self.gaps = 0
+
+    def feed(self, seq, flags, payload):
+        """Return (first_bin, step_db, [level q]) or None while waiting."""
+        if self.last_seq is not None and seq != (self.last_seq + 1) % 256:
+            self.gaps += 1
+            self.levels = None
+        self.last_seq = seq
+
+        first_bin, n_bins, step_ddb = struct.unpack_from("<HBB", payload)
+        data = payload[4:]
+        if flags & KEY:
+            self.levels = list(data[:n_bins])
+        elif self.levels is None or len(self.levels) != n_bins:
+            return None
+        elif flags & NIBBLES:
+            for i in range(n_bins):
+                d = (data[i // 2] >> (4 * (i & 1))) & 0x0F
+                self.levels[i] += d - 16 if d & 0x08 else d
+        else:
+            for i in range(n_bins):
+                self.levels[i] += struct.unpack_from("b", data, i)[0]
+        return first_bin, step_ddb / 10.0, list(self.levels)
+
+
+def lines(args):
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=1) as ser:
+            while True:
+                yield ser.readline().decode(errors="replace")
+    else:
+        yield from sys.stdin
+
+
+def show_text(first_bin, step_db, levels, bin_hz):
+    print("\033[H\033[J", end="")
+    for i, q in enumerate(levels):
+        db = q * step_db
+        print(f"{(first_bin + i) * bin_hz:7.1f} Hz {db:5.1f} dB "
+              + "#" * int(db / BAR_DB))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--port", help="base node serial port (default: stdin)")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--bin-hz", type=float, default=16000 / 1024,
+                    help="FFT bin width on the peripheral")
+    ap.add_argument("--plot", action="store_true", help="matplotlib instead of text")
+    args = ap.parse_args()
+
+    dec = Decoder()
+    plot = None
+    if args.plot:
+        import matplotlib.pyplot as plt
+        plt.ion()
+        fig, ax = plt.subplots()
+        ax.set_xlabel("Hz")
+        ax.set_ylabel("dB")
+
+    for line in lines(args):
+        m = SPEC.search(line)
+        if not m:
+            continue
+        out = dec.feed(int(m.group(1)), int(m.group(2), 16),
+                       bytes.fromhex(m.group(3)))
+        if out is None:
+            continue
+        first_bin, step_db, levels = out
+        if args.plot:
+            freqs = [(first_bin + i) * args.bin_hz for i in range(len(levels))]
+            dbs = [q * step_db for q in levels]
+            if plot is None or len(plot.get_xdata()) != len(freqs):
+                ax.clear()
+                (plot,) = ax.plot(freqs, dbs)
+                ax.set_ylim(0, 160)
+            else:
+                plot.set_ydata(dbs)
+            plt.pause(0.001)
+        else:
+            show_text(first_bin, step_db, levels, args.bin_hz)
+    print(f"sequence gaps: {dec.gaps}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
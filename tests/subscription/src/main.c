@@ -0,0 +1,140 @@
+/* tests/subscription/src/main.c
+ *
+ * A central's subscription must only cap the report rate: the change-
+ * only hysteresis and the heartbeat stay in force, and dropping the
+ * link gives back the interval without touching the rest of the
+ * report config.
+ */
+
+#include <math.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include "nus_proto.h"
+#include "report_policy.h"
+#include "subscription.h"
+
+#define BLOCK_MS  100               /* one pitch result per DMIC block */
+
+/* A report config as the 'c' command would set it */
+static const struct report_policy_cfg user_cfg = {
+    .hyst_cents      = 2.0f,
+    .min_interval_ms = 40,
+    .heartbeat_ms    = 1000,
+};
+
+static void subscribe(uint16_t rate_dhz)
+{
+    struct nus_subscribe_cmd cmd = {
+        .cmd      = NUS_CMD_SUBSCRIBE,
+        .rate_dhz = rate_dhz,
+        .detail   = NUS_DETAIL_BASIC,
+    };
+    zassert_equal(subscription_set(&cmd), 0);
+}
+
+/* One result that, when the policy lets it go, reaches the stack */
+static bool offer(float freq_hz, const char *note, uint32_t now_ms)
+{
+    if (!report_policy_should_send(freq_hz, note, now_ms)) {
+        return false;
+    }
+    report_policy_sent(freq_hz, note, now_ms);
+    return true;
+}
+
+/* Results of one pitch, one per block over [from_ms, to_ms); returns
+ * how many go out and the time of the last one */
+static uint32_t feed(float freq_hz, const char *note, uint32_t from_ms,
+                     uint32_t to_ms, uint32_t *last_ms)
+{
+    uint32_t sent = 0;
+    for (uint32_t t = from_ms; t < to_ms; t += BLOCK_MS) {
+        if (offer(freq_hz, note, t)) {
+            sent++;
+            *last_ms = t;
+        }
+    }
+    return sent;
+}
+
+ZTEST(subscription, test_steady_pitch_held_to_heartbeat)
+{
+    uint32_t last = 0;
+
+    /* A subscription at the block rate, as the central sends on connect */
+    subscribe(100);
+
+    /* Steady A2: the first frame, then one per heartbeat */
+    zassert_equal(feed(110.0f, "A2", 0, 2500, &last), 3);
+    zassert_equal(last, 2000);
+
+    /* Within the hysteresis: nothing until the next heartbeat */
+    zassert_equal(feed(110.1f, "A2", 2500, 2900, &last), 0);
+
+    /* A real change goes out at once */
+    zassert_equal(feed(112.0f, "A2", 2900, 3000, &last), 1);
+    zassert_equal(last, 2900);
+}
+
+ZTEST(subscription, test_rate_caps_changes)
+{
+    uint32_t sent = 0;
+
+    /* 2 frames/s: a pitch gliding 5 cents per block is a change every
+     * block, but only every 500 ms may go out */
+    subscribe(20);
+    for (uint32_t i = 0; i < 20; i++) {
+        float f = 110.0f * exp2f(5.0f * i / 1200.0f);
+        sent += offer(f, "A2", i * BLOCK_MS);
+    }
+    zassert_equal(sent, 4, "%u frames in 2 s", sent);
+}
+
+ZTEST(subscription, test_unsent_frame_offered_again)
+{
+    struct report_policy_stats before, after;
+
+    subscribe(100);
+    report_policy_stats_get(&before);
+
+    /* The first frame finds no buffer: the next result goes instead */
+    zassert_true(report_policy_should_send(110.0f, "A2", 0));
+    zassert_true(offer(110.0f, "A2", BLOCK_MS));
+    /* ... and only that one counts, and holds back a steady pitch */
+    zassert_false(offer(110.0f, "A2", 2 * BLOCK_MS));
+
+    report_policy_stats_get(&after);
+    zassert_equal(after.sent_change - before.sent_change, 1);
+}
+
+ZTEST(subscription, test_reset_keeps_report_cfg)
+{
+    struct report_policy_cfg cfg;
+
+    subscribe(50);
+    report_policy_get(&cfg);
+    zassert_equal(cfg.min_interval_ms, 200);
+    zassert_equal(cfg.heartbeat_ms, user_cfg.heartbeat_ms);
+
+    /* Link drop: the interval comes back, the rest never left */
+    subscription_reset();
+    report_policy_get(&cfg);
+    zassert_equal(cfg.min_interval_ms, user_cfg.min_interval_ms);
+    zassert_equal(cfg.heartbeat_ms, user_cfg.heartbeat_ms);
+    zassert_within(cfg.hyst_cents, user_cfg.hyst_cents, 1e-6f);
+}
+
+static void before_each(void *fixture)
+{
+    subscription_reset();
+    report_policy_set(&user_cfg);
+    report_policy_reset();
+}
+
+static void *suite_setup(void)
+{
+    subscription_init(100);
+    return NULL;
+}
+
+ZTEST_SUITE(subscription, NULL, suite_setup, before_each, NULL, NULL);